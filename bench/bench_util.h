@@ -0,0 +1,84 @@
+// Simon Says benchmarks: helpers shared by the load generator and benchmarks (synthetic poses,
+// percentiles, offscreen stick man rendering).
+
+#pragma once
+
+#ifndef SDL_MAIN_HANDLED
+#define SDL_MAIN_HANDLED
+#endif
+#include "RealSenseID/FaceAuthenticator.h"
+#include "runtime.h"
+#include "stick_man.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace simonsays {
+
+// Standing figure in camera (1920x1080) coordinates, arms waving with phase t.
+inline void synth_pose(RealSenseID::PersonPose& p, int person, double t) {
+    static const int base_x[NUM_POSE_LANDMARKS] = {0, -15, 15, -35, 35, -90, 90, -120, 120, -140, 140, -60, 60, -65, 65, -70, 70};
+    static const int base_y[NUM_POSE_LANDMARKS] = {-330, -345, -345, -335, -335, -220, -220, -100, -100, 10, 10, 40, 40, 220, 220, 400, 400};
+    std::memset(&p, 0, sizeof(p));
+    double cx = 300.0 + (person % 5) * 330.0;
+    double cy = 540.0;
+    double wave = std::sin(t * 4.0 + person) * 120.0;
+    for (int i = 0; i < NUM_POSE_LANDMARKS; i++) {
+        double x = cx + base_x[i];
+        double y = cy + base_y[i];
+        if (i == 9 || i == 10) y -= wave;           // wrists
+        if (i == 7 || i == 8) y -= wave * 0.5;      // elbows
+        p.lm_x[i] = static_cast<uint32_t>(std::max(1.0, x));
+        p.lm_y[i] = static_cast<uint32_t>(std::max(1.0, y));
+    }
+}
+
+inline int64_t percentile(std::vector<int64_t>& v, double q) {
+    if (v.empty()) return 0;
+    size_t idx = static_cast<size_t>(q * (v.size() - 1) + 0.5);
+    std::nth_element(v.begin(), v.begin() + idx, v.end());
+    return v[idx];
+}
+
+// Offscreen stick man target: SDL software renderer on a surface when SDL is available,
+// otherwise only the camera -> window transform.
+class OffscreenRenderer {
+public:
+    OffscreenRenderer() {
+#ifndef SIMONSAYS_NO_SDL
+        _surface = SDL_CreateRGBSurfaceWithFormat(0, POSE_WINDOW_W, POSE_WINDOW_H, 32, SDL_PIXELFORMAT_RGBA32);
+        if (_surface) _renderer = SDL_CreateSoftwareRenderer(_surface);
+#endif
+    }
+    ~OffscreenRenderer() {
+#ifndef SIMONSAYS_NO_SDL
+        if (_renderer) SDL_DestroyRenderer(_renderer);
+        if (_surface) SDL_FreeSurface(_surface);
+#endif
+    }
+
+    void render(const std::vector<RealSenseID::PersonPose>& poses) {
+#ifndef SIMONSAYS_NO_SDL
+        if (_renderer) {
+            SDL_SetRenderDrawColor(_renderer, 20, 20, 30, 255);
+            SDL_RenderClear(_renderer);
+            draw_stick_man(_renderer, poses);
+            SDL_RenderPresent(_renderer);
+            return;
+        }
+#endif
+        if (!poses.empty()) layout_stick_man(poses[0], POSE_WINDOW_W, POSE_WINDOW_H, _figure);
+    }
+
+private:
+#ifndef SIMONSAYS_NO_SDL
+    SDL_Surface* _surface = nullptr;
+    SDL_Renderer* _renderer = nullptr;
+#endif
+    StickFigure _figure;
+};
+
+} // namespace simonsays
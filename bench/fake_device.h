@@ -0,0 +1,122 @@
+// Simon Says benchmarks: stand-in for RealSenseID::FaceAuthenticator, so PoseSession can run
+// end to end without hardware. AuthenticateLoop streams synthetic poses at a fixed rate until
+// Cancel() (empty pose lists while nobody is present); Authenticate and SetDeviceConfig take the
+// configured serial/match latency.
+
+#pragma once
+
+#include "RealSenseID/FaceAuthenticator.h"
+#include "bench_util.h"
+#include "runtime.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace simonsays {
+
+struct FakeDeviceConfig {
+    double pose_rate_hz = 30.0;
+    int persons = 1;
+    std::chrono::milliseconds auth_latency{300};   // one-shot face match
+    std::chrono::milliseconds config_latency{20};  // SetDeviceConfig round trip
+    bool auth_succeeds = true;
+};
+
+class FakeDevice {
+public:
+    explicit FakeDevice(FakeDeviceConfig config = {}) : _config(config), _start(Clock::now()) {}
+
+    RealSenseID::Status AuthenticateLoop(RealSenseID::AuthenticationCallback& cb) {
+        begin();
+        auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / _config.pose_rate_hz));
+        std::vector<RealSenseID::PersonPose> poses;
+        const auto started = Clock::now();
+        auto next = started;
+        while (!wait_cancelled(next)) {
+            auto now = Clock::now();
+            double t = std::chrono::duration<double>(now - _start).count();
+            poses.resize(_present ? _config.persons : 0);
+            for (size_t i = 0; i < poses.size(); i++) synth_pose(poses[i], static_cast<int>(i), t);
+            cb.OnPoseDetected(poses, static_cast<unsigned int>(t * 1000.0));
+            ++_frames;
+            next += period;
+        }
+        _streaming_us += std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started).count();
+        end();
+        return RealSenseID::Status::Ok;
+    }
+
+    RealSenseID::Status Authenticate(RealSenseID::AuthenticationCallback& cb) {
+        begin();
+        bool cancelled = wait_cancelled(Clock::now() + _config.auth_latency);
+        end();
+        cb.OnResult(!cancelled && _present && _config.auth_succeeds ? RealSenseID::AuthenticateStatus::Success
+                                                        : RealSenseID::AuthenticateStatus::Failure,
+                    "player1", 0);
+        return RealSenseID::Status::Ok;
+    }
+
+    // Like the SDK, only ends an operation that is in progress.
+    RealSenseID::Status Cancel() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_busy) {
+            _cancel = true;
+            _cv.notify_all();
+        }
+        return RealSenseID::Status::Ok;
+    }
+
+    RealSenseID::Status QueryDeviceConfig(RealSenseID::DeviceConfig& config) {
+        config = _device_config;
+        return RealSenseID::Status::Ok;
+    }
+
+    RealSenseID::Status SetDeviceConfig(const RealSenseID::DeviceConfig& config) {
+        std::this_thread::sleep_for(_config.config_latency);
+        _device_config = config;
+        return RealSenseID::Status::Ok;
+    }
+
+    // Someone in front of the camera: poses in the stream and re-auth succeeds.
+    void set_person_present(bool present) { _present = present; }
+
+    uint64_t frames_sent() const { return _frames.load(); }
+    // Total time spent inside AuthenticateLoop.
+    double streaming_seconds() const { return _streaming_us.load() * 1e-6; }
+
+private:
+    void begin() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _busy = true;
+        _cancel = false;
+    }
+
+    void end() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _busy = false;
+    }
+
+    // Sleeps until deadline; returns true if Cancel() came first.
+    bool wait_cancelled(Clock::time_point deadline) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        return _cv.wait_until(lock, deadline, [this]() { return _cancel; });
+    }
+
+    const FakeDeviceConfig _config;
+    const Clock::time_point _start;
+    RealSenseID::DeviceConfig _device_config;  // only touched on the device worker
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _busy = false;
+    bool _cancel = false;
+    std::atomic<bool> _present{true};
+    std::atomic<uint64_t> _frames{0};
+    std::atomic<int64_t> _streaming_us{0};
+};
+
+} // namespace simonsays
@@ -0,0 +1,98 @@
+// Simon Says kinematics benchmark: cost of KinematicsBatch::update + ScoringEngine::update per
+// frame for growing numbers of people, as a share of the frame budget. The rates are simulated:
+// frames run back to back, and 30/60/120 Hz only sets dt, the clip length and the budget.
+//
+// Usage: simonsays_kinematics_bench [--people 1,8,32,128] [--seconds SEC]
+
+#include "bench_util.h"
+#include "kinematics.h"
+#include "scoring.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::vector<int> people = {1, 8, 32, 128};
+    double seconds = 10.0;  // simulated dance length per step
+};
+
+const double RATES_HZ[] = {30.0, 60.0, 120.0};
+
+void run_step(double rate_hz, int people, const Options& opt) {
+    using clock = std::chrono::steady_clock;
+    const int frames = std::max(1, static_cast<int>(opt.seconds * rate_hz));
+    const float dt = static_cast<float>(1.0 / rate_hz);
+
+    // Poses are generated up front so only kinematics and scoring are timed.
+    std::vector<std::vector<RealSenseID::PersonPose>> clip(frames, std::vector<RealSenseID::PersonPose>(people));
+    for (int f = 0; f < frames; f++)
+        for (int p = 0; p < people; p++) simonsays::synth_pose(clip[f][p], p, f * dt);
+
+    simonsays::KinematicsBatch kinematics(people);
+    simonsays::ScoringEngine scoring({}, people);
+    std::vector<double> frame_ns(frames);
+    auto t0 = clock::now();
+    for (int f = 0; f < frames; f++) {
+        auto s = clock::now();
+        kinematics.update(clip[f], f == 0 ? 0.0f : dt);
+        scoring.update(kinematics, f * dt);
+        frame_ns[f] = std::chrono::duration<double, std::nano>(clock::now() - s).count();
+    }
+    double total_ns = std::chrono::duration<double, std::nano>(clock::now() - t0).count();
+
+    std::sort(frame_ns.begin(), frame_ns.end());
+    double mean = total_ns / frames;
+    double p99 = frame_ns[static_cast<size_t>(0.99 * (frames - 1))];
+    double budget_ns = 1e9 / rate_hz;
+    std::printf("%7.0f %7d %8d %11.0f %11.0f %13.1f %10.4f %9.1f\n", rate_hz, people, frames, mean, p99,
+                mean / people, 100.0 * mean / budget_ns, scoring.score(0).total);
+}
+
+bool parse_args(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto value = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+        if (a == "--people") {
+            const char* v = value();
+            if (!v) return false;
+            opt.people.clear();
+            for (const char* p = v; *p;) {
+                opt.people.push_back(std::atoi(p));
+                while (*p && *p != ',') ++p;
+                if (*p == ',') ++p;
+            }
+        } else if (a == "--seconds") {
+            const char* v = value();
+            if (!v) return false;
+            opt.seconds = std::atof(v);
+        } else {
+            return false;
+        }
+    }
+    opt.people.erase(std::remove_if(opt.people.begin(), opt.people.end(), [](int n) { return n <= 0; }), opt.people.end());
+    return opt.seconds > 0 && !opt.people.empty();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse_args(argc, argv, opt)) {
+        std::fprintf(stderr, "Usage: %s [--people 1,8,32,128] [--seconds SEC]\n", argv[0]);
+        return 1;
+    }
+    std::printf("Kinematics + scoring benchmark: %d limbs, %.1f s simulated per step, frames run back to back "
+                "(sim_hz sets dt and the budget only)\n",
+                simonsays::NUM_LIMBS, opt.seconds);
+    std::printf("%7s %7s %8s %11s %11s %13s %10s %9s\n", "sim_hz", "people", "frames", "mean_ns", "p99_ns",
+                "ns/person", "budget%", "score0");
+    for (double rate : RATES_HZ)
+        for (int n : opt.people) run_step(rate, n, opt);
+    return 0;
+}
@@ -0,0 +1,222 @@
+// Simon Says load generator: N simulated OnPoseDetected producers, each feeding its own
+// handoff -> processing -> render path (the same PosePipeline/PoseWatchdog/stick man code the
+// app uses), rendering offscreen. Reports per-session latency percentiles, dropped frames and
+// process CPU use as the session count grows, to find where the pipeline stops scaling.
+//
+// Usage: simonsays_loadgen [--sessions 1,2,4,...] [--rate HZ] [--persons N] [--duration SEC]
+//                          [--deadline-ms MS] [--per-session]
+
+#include "bench_util.h"
+#include "pose_pipeline.h"
+#include "runtime.h"
+#include "stick_man.h"
+#include "watchdog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using simonsays::Clock;
+using simonsays::OffscreenRenderer;
+using simonsays::percentile;
+using simonsays::synth_pose;
+
+struct Options {
+    std::vector<int> sessions = {1, 2, 4, 8, 16, 32, 64};
+    double rate_hz = 30.0;
+    int persons = 1;
+    double duration_sec = 5.0;
+    int deadline_ms = 200;
+    bool per_session = false;
+};
+
+struct SessionResult {
+    uint64_t produced = 0;
+    uint64_t rendered = 0;
+    uint64_t dropped = 0;
+    std::vector<int64_t> latency_us;  // arrival -> rendered
+};
+
+class Session {
+public:
+    Session(int id, const Options& opt)
+        : _id(id), _opt(opt), _watchdog(make_config(opt)), _pipeline(_watchdog),
+          _callback(_watchdog, _pipeline, _authenticated) {}
+
+    void start() {
+        _pipeline.start();
+        _render = std::thread([this]() { render_loop(); });
+        _producer = std::thread([this]() { produce_loop(); });
+    }
+
+    void stop() {
+        _stop = true;
+        if (_producer.joinable()) _producer.join();
+        _pipeline.close();
+        _pipeline.join();
+        _drained = true;  // the render queue is closed; what is left in it still gets rendered
+        if (_render.joinable()) _render.join();
+        // This renderer takes every frame, so one replaced in the render slot was missed too.
+        _result.dropped = _pipeline.dropped() + _pipeline.superseded() + _watchdog.stats(Clock::now()).stale_dropped;
+    }
+
+    const SessionResult& result() const { return _result; }
+
+private:
+    static simonsays::WatchdogConfig make_config(const Options& opt) {
+        simonsays::WatchdogConfig c;
+        c.frame_deadline = std::chrono::milliseconds(opt.deadline_ms);
+        return c;
+    }
+
+    void produce_loop() {
+        auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / _opt.rate_hz));
+        auto start = Clock::now();
+        auto next = start;
+        std::vector<RealSenseID::PersonPose> poses(_opt.persons);
+        while (!_stop) {
+            std::this_thread::sleep_until(next);
+            auto now = Clock::now();
+            double t = std::chrono::duration<double>(now - start).count();
+            for (int i = 0; i < _opt.persons; i++) synth_pose(poses[i], i + _id, t);
+            auto device_ts = static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count());
+            _callback.OnPoseDetected(poses, device_ts);
+            ++_result.produced;
+            next += period;
+        }
+    }
+
+    void render_loop() {
+        OffscreenRenderer out;
+        simonsays::PoseFrame frame;
+        for (;;) {
+            if (!_pipeline.next_frame(frame, std::chrono::milliseconds(33))) {
+                if (_drained) break;
+                continue;
+            }
+            out.render(frame.poses);
+            _result.latency_us.push_back(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - frame.arrival).count());
+            ++_result.rendered;
+        }
+    }
+
+    const int _id;
+    const Options& _opt;
+    simonsays::PoseWatchdog _watchdog;
+    simonsays::PosePipeline _pipeline;
+    std::atomic<bool> _authenticated{true};
+    simonsays::PoseStreamCallback _callback;
+    std::thread _producer;
+    std::thread _render;
+    std::atomic<bool> _stop{false};
+    std::atomic<bool> _drained{false};
+    SessionResult _result;
+};
+
+void run_step(int n, const Options& opt) {
+    std::vector<std::unique_ptr<Session>> sessions;
+    for (int i = 0; i < n; i++) sessions.push_back(std::make_unique<Session>(i, opt));
+
+    double cpu0 = simonsays::process_cpu_seconds();
+    auto t0 = Clock::now();
+    for (auto& s : sessions) s->start();
+    std::this_thread::sleep_for(std::chrono::duration<double>(opt.duration_sec));
+    for (auto& s : sessions) s->stop();
+    double wall = std::chrono::duration<double>(Clock::now() - t0).count();
+    double cpu = simonsays::process_cpu_seconds() - cpu0;
+
+    uint64_t produced = 0, rendered = 0, dropped = 0;
+    std::vector<int64_t> all, p99s;
+    for (int i = 0; i < n; i++) {
+        SessionResult r = sessions[i]->result();
+        produced += r.produced;
+        rendered += r.rendered;
+        dropped += r.dropped;
+        all.insert(all.end(), r.latency_us.begin(), r.latency_us.end());
+        int64_t p50 = percentile(r.latency_us, 0.50), p95 = percentile(r.latency_us, 0.95), p99 = percentile(r.latency_us, 0.99);
+        p99s.push_back(p99);
+        if (opt.per_session)
+            std::printf("  session %3d: produced %6llu rendered %6llu dropped %5llu  p50 %6lld us  p95 %6lld us  p99 %6lld us\n",
+                        i, static_cast<unsigned long long>(r.produced), static_cast<unsigned long long>(r.rendered),
+                        static_cast<unsigned long long>(r.dropped), static_cast<long long>(p50),
+                        static_cast<long long>(p95), static_cast<long long>(p99));
+    }
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("%8d %9llu %9llu %8llu %8lld %8lld %8lld %12lld %9.1f %9.1f\n", n,
+                static_cast<unsigned long long>(produced), static_cast<unsigned long long>(rendered),
+                static_cast<unsigned long long>(dropped), static_cast<long long>(percentile(all, 0.50)),
+                static_cast<long long>(percentile(all, 0.95)), static_cast<long long>(percentile(all, 0.99)),
+                static_cast<long long>(p99s.empty() ? 0 : *std::max_element(p99s.begin(), p99s.end())),
+                100.0 * cpu / wall, 100.0 * cpu / wall / cores);
+    std::fflush(stdout);
+}
+
+bool parse_args(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto value = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+        if (a == "--sessions") {
+            const char* v = value();
+            if (!v) return false;
+            opt.sessions.clear();
+            for (const char* p = v; *p;) {
+                opt.sessions.push_back(std::atoi(p));
+                while (*p && *p != ',') ++p;
+                if (*p == ',') ++p;
+            }
+        } else if (a == "--rate") {
+            const char* v = value();
+            if (!v) return false;
+            opt.rate_hz = std::atof(v);
+        } else if (a == "--persons") {
+            const char* v = value();
+            if (!v) return false;
+            opt.persons = std::atoi(v);
+        } else if (a == "--duration") {
+            const char* v = value();
+            if (!v) return false;
+            opt.duration_sec = std::atof(v);
+        } else if (a == "--deadline-ms") {
+            const char* v = value();
+            if (!v) return false;
+            opt.deadline_ms = std::atoi(v);
+        } else if (a == "--per-session") {
+            opt.per_session = true;
+        } else {
+            return false;
+        }
+    }
+    opt.sessions.erase(std::remove_if(opt.sessions.begin(), opt.sessions.end(), [](int n) { return n <= 0; }), opt.sessions.end());
+    return opt.rate_hz > 0 && opt.persons > 0 && opt.duration_sec > 0 && !opt.sessions.empty();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse_args(argc, argv, opt)) {
+        std::fprintf(stderr, "Usage: %s [--sessions 1,2,4,...] [--rate HZ] [--persons N] [--duration SEC] "
+                             "[--deadline-ms MS] [--per-session]\n", argv[0]);
+        return 1;
+    }
+#ifdef SIMONSAYS_NO_SDL
+    const char* render_mode = "transform only (no SDL)";
+#else
+    const char* render_mode = "SDL software renderer";
+#endif
+    std::printf("Pose pipeline load test: %.1f Hz, %d person(s), %.1f s per step, deadline %d ms, %u cores, render: %s\n",
+                opt.rate_hz, opt.persons, opt.duration_sec, opt.deadline_ms, std::thread::hardware_concurrency(), render_mode);
+    std::printf("%8s %9s %9s %8s %8s %8s %8s %12s %9s %9s\n", "sessions", "produced", "rendered", "dropped",
+                "p50_us", "p95_us", "p99_us", "worst_p99_us", "cpu%", "cpu%/core");
+    for (int n : opt.sessions) run_step(n, opt);
+    return 0;
+}
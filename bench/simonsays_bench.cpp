@@ -0,0 +1,702 @@
+// Simon Says benchmark suite: micro-benchmarks of the library pieces (pose handoff, stick man
+// transform/draw, device selection, kinematics + scoring, metrics updates and export, trace
+// points, SignHelper sign/verify in secure builds),
+// an end-to-end session against a fake device and an idle/wake-up cycle. Results can be written as JSON and compared
+// against a previous run to catch regressions between commits.
+//
+// Usage: simonsays_bench [--filter TEXT] [--min-time SEC] [--e2e-seconds SEC] [--label TEXT]
+//                        [--json FILE] [--compare FILE] [--threshold PCT] [--trace FILE]
+//
+// --trace captures the end-to-end and idle runs as a Chrome trace (see trace.h).
+//
+// The JSON file holds one result object per line so it diffs cleanly and --compare can read it
+// back without a JSON library. --compare exits with status 2 when any result got worse by more
+// than --threshold percent (default 10).
+
+#include "bench_util.h"
+#include "device_select.h"
+#include "fake_device.h"
+#include "kinematics.h"
+#include "metrics.h"
+#include "pose_pipeline.h"
+#include "pose_session.h"
+#include "runtime.h"
+#include "scoring.h"
+#include "stick_man.h"
+#include "trace.h"
+#include "watchdog.h"
+#ifdef RSID_SECURE
+#include "secure_mode_helper.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using simonsays::Clock;
+
+struct Options {
+    std::string filter;
+    double min_time_sec = 0.5;  // per micro-benchmark
+    double e2e_seconds = 5.0;
+    std::string label;
+    std::string json_path;
+    std::string trace_path;
+    std::string compare_path;
+    double threshold_pct = 10.0;
+};
+
+struct Result {
+    std::string name;
+    std::string unit;
+    double value = 0;
+    double min = 0;
+    uint64_t iterations = 0;
+    bool lower_is_better = true;
+};
+
+// Results of every op feed this so the optimizer cannot drop the work.
+volatile uint64_t g_sink = 0;
+
+bool selected(const Options& opt, const std::string& name) {
+    return opt.filter.empty() || name.find(opt.filter) != std::string::npos;
+}
+
+// Runs op (which returns a value for the sink) in batches sized so that 7 samples take about
+// min_time; reports the median and fastest sample in ns/op.
+template <typename Op>
+Result measure(const std::string& name, double min_time_sec, Op&& op) {
+    constexpr int SAMPLES = 7;
+    auto run = [&](uint64_t n) {
+        uint64_t sink = 0;
+        auto t0 = Clock::now();
+        for (uint64_t i = 0; i < n; i++) sink += op();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+        g_sink = g_sink + sink;
+        return ns;
+    };
+
+    const double sample_ns = min_time_sec * 1e9 / SAMPLES;
+    uint64_t iters = 1;
+    for (;;) {
+        double ns = run(iters);
+        if (ns >= sample_ns / 10 || iters >= (1ull << 32)) {
+            iters = std::max<uint64_t>(1, static_cast<uint64_t>(iters * sample_ns / std::max(ns, 1.0)));
+            break;
+        }
+        iters *= 4;
+    }
+
+    std::vector<double> per_op;
+    for (int s = 0; s < SAMPLES; s++) per_op.push_back(run(iters) / iters);
+    std::sort(per_op.begin(), per_op.end());
+    Result r;
+    r.name = name;
+    r.unit = "ns/op";
+    r.value = per_op[SAMPLES / 2];
+    r.min = per_op.front();
+    r.iterations = iters * SAMPLES;
+    return r;
+}
+
+void print_result(const Result& r) {
+    std::printf("%-36s %14.1f %-6s (min %.1f, %llu iterations)\n", r.name.c_str(), r.value, r.unit.c_str(), r.min,
+                static_cast<unsigned long long>(r.iterations));
+    std::fflush(stdout);
+}
+
+// ---- Micro-benchmarks ----
+
+void bench_stick_man(const Options& opt, std::vector<Result>& out) {
+    std::vector<RealSenseID::PersonPose> poses(1);
+    simonsays::synth_pose(poses[0], 0, 0.3);
+    if (selected(opt, "stick_man/layout")) {
+        simonsays::StickFigure fig;
+        out.push_back(measure("stick_man/layout", opt.min_time_sec, [&]() {
+            simonsays::layout_stick_man(poses[0], simonsays::POSE_WINDOW_W, simonsays::POSE_WINDOW_H, fig);
+            return static_cast<uint64_t>(fig.num_lines + fig.lines[0].x0);
+        }));
+    }
+#ifndef SIMONSAYS_NO_SDL
+    if (selected(opt, "stick_man/draw_software")) {
+        simonsays::OffscreenRenderer renderer;
+        out.push_back(measure("stick_man/draw_software", opt.min_time_sec, [&]() {
+            renderer.render(poses);
+            return uint64_t{1};
+        }));
+    }
+#endif
+}
+
+void bench_device_select(const Options& opt, std::vector<Result>& out) {
+    auto probe = [](const char*) { return RealSenseID::DeviceType::Unknown; };
+    for (size_t n : {1, 4, 16}) {
+        // Worst case for the preference scan: the only F46x is last.
+        std::vector<RealSenseID::DeviceInfo> devices(n);
+        for (size_t i = 0; i < n; i++) {
+            std::snprintf(devices[i].serialPort, sizeof(devices[i].serialPort), "COM%zu", i + 3);
+            devices[i].deviceType = i + 1 == n ? RealSenseID::DeviceType::F46x : RealSenseID::DeviceType::F45x;
+        }
+        std::string name = "device_select/discovered_" + std::to_string(n);
+        std::string port;
+        RealSenseID::DeviceType type;
+        if (selected(opt, name)) {
+            out.push_back(measure(name, opt.min_time_sec, [&]() {
+                simonsays::select_rsid_device(devices, nullptr, probe, port, type);
+                return static_cast<uint64_t>(port.size());
+            }));
+        }
+        name = "device_select/rsid_port_" + std::to_string(n);
+        std::string env = devices.back().serialPort;
+        if (selected(opt, name)) {
+            out.push_back(measure(name, opt.min_time_sec, [&]() {
+                simonsays::select_rsid_device(devices, env.c_str(), probe, port, type);
+                return static_cast<uint64_t>(port.size());
+            }));
+        }
+    }
+}
+
+void bench_pose_handoff(const Options& opt, std::vector<Result>& out) {
+    std::vector<RealSenseID::PersonPose> poses(2);
+    simonsays::synth_pose(poses[0], 0, 0.1);
+    simonsays::synth_pose(poses[1], 1, 0.1);
+
+    // Callback-side cost only: the processing thread is not running, so the queue stays full and
+    // every handoff also drops the oldest frame.
+    if (selected(opt, "pose_handoff/handoff")) {
+        simonsays::PoseWatchdog watchdog;
+        simonsays::PosePipeline pipeline(watchdog);
+        unsigned int ts = 0;
+        out.push_back(measure("pose_handoff/handoff", opt.min_time_sec, [&]() {
+            return static_cast<uint64_t>(pipeline.handoff(poses, ++ts, Clock::now()));
+        }));
+    }
+
+    // OnPoseDetected -> processing thread -> render stage, one frame in flight.
+    if (selected(opt, "pose_handoff/round_trip")) {
+        simonsays::PoseWatchdog watchdog;
+        simonsays::PosePipeline pipeline(watchdog);
+        std::atomic<bool> authenticated{true};
+        simonsays::PoseStreamCallback cb(watchdog, pipeline, authenticated);
+        pipeline.start();
+        simonsays::PoseFrame frame;
+        unsigned int ts = 0;
+        out.push_back(measure("pose_handoff/round_trip", opt.min_time_sec, [&]() {
+            cb.OnPoseDetected(poses, ++ts);
+            return static_cast<uint64_t>(pipeline.next_frame(frame, std::chrono::seconds(1)));
+        }));
+        pipeline.close();
+        pipeline.join();
+    }
+
+    // Same with the app's metrics attached, to keep their hot-path cost visible.
+    if (selected(opt, "pose_handoff/round_trip_metrics")) {
+        simonsays::PoseWatchdog watchdog;
+        simonsays::PosePipeline pipeline(watchdog);
+        std::atomic<bool> authenticated{true};
+        simonsays::MetricsRegistry registry;
+        simonsays::AppMetrics metrics(registry);
+        simonsays::PoseStreamCallback cb(watchdog, pipeline, authenticated, nullptr, &metrics);
+        pipeline.start();
+        simonsays::PoseFrame frame;
+        unsigned int ts = 0;
+        out.push_back(measure("pose_handoff/round_trip_metrics", opt.min_time_sec, [&]() {
+            cb.OnPoseDetected(poses, ++ts);
+            return static_cast<uint64_t>(pipeline.next_frame(frame, std::chrono::seconds(1)));
+        }));
+        pipeline.close();
+        pipeline.join();
+    }
+}
+
+void bench_metrics(const Options& opt, std::vector<Result>& out) {
+    simonsays::MetricsRegistry registry;
+    simonsays::AppMetrics metrics(registry);
+    if (selected(opt, "metrics/counter_inc")) {
+        out.push_back(measure("metrics/counter_inc", opt.min_time_sec, [&]() {
+            metrics.pose_callbacks.inc();
+            return uint64_t{1};
+        }));
+    }
+    if (selected(opt, "metrics/histogram_observe")) {
+        double v = 0;
+        out.push_back(measure("metrics/histogram_observe", opt.min_time_sec, [&]() {
+            v = v < 0.5 ? v + 0.001 : 0;
+            metrics.render_frame_seconds.observe(v);
+            return uint64_t{1};
+        }));
+    }
+    // Every thread hammering the same counter: with per-thread shards the cost per increment
+    // should stay close to the single-thread figure (given at least four cores).
+    if (selected(opt, "metrics/counter_inc_4_threads")) {
+        constexpr int THREADS = 3;  // plus the measuring thread
+        std::atomic<bool> done{false};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; t++)
+            threads.emplace_back([&]() {
+                while (!done.load(std::memory_order_relaxed)) metrics.pose_callbacks.inc();
+            });
+        out.push_back(measure("metrics/counter_inc_4_threads", opt.min_time_sec, [&]() {
+            metrics.pose_callbacks.inc();
+            return uint64_t{1};
+        }));
+        done = true;
+        for (auto& t : threads) t.join();
+    }
+    if (selected(opt, "metrics/export")) {
+        out.push_back(measure("metrics/export", opt.min_time_sec, [&]() {
+            return static_cast<uint64_t>(registry.prometheus_text().size());
+        }));
+    }
+}
+
+// Trace points with capture off (the cost every build pays) and on. With capture on, events are
+// recorded in batches that fit the ring and drained between batches, outside the timed part, so
+// the figure is what an instrumented thread pays; writing JSON is the background writer's job.
+void bench_trace(const Options& opt, std::vector<Result>& out) {
+#ifndef SIMONSAYS_NO_TRACE
+    if (selected(opt, "trace/scope_off")) {
+        out.push_back(measure("trace/scope_off", opt.min_time_sec, [&]() {
+            SIMONSAYS_TRACE_SCOPE("bench", "bench");
+            return uint64_t{1};
+        }));
+    }
+    if (selected(opt, "trace/scope_on")) {
+        constexpr int SAMPLES = 7;
+        constexpr uint64_t BATCH = 8192;
+        const std::string path = "simonsays_bench_trace.json";
+        simonsays::Tracer& tracer = simonsays::Tracer::instance();
+        simonsays::TraceConfig config;
+        config.buffer_events = BATCH;
+        config.flush_period = std::chrono::seconds(3600);  // drained below instead
+        if (!tracer.start(path, config)) {
+            std::fprintf(stderr, "Cannot write %s; skipping trace/scope_on\n", path.c_str());
+            return;
+        }
+        std::vector<double> per_event;
+        uint64_t events = 0;
+        for (int sample = 0; sample < SAMPLES; sample++) {
+            double ns = 0;
+            uint64_t n = 0;
+            const auto sample_end = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                                       std::chrono::duration<double>(opt.min_time_sec / SAMPLES));
+            while (Clock::now() < sample_end) {
+                auto t0 = Clock::now();
+                for (uint64_t i = 0; i < BATCH; i++) {
+                    SIMONSAYS_TRACE_SCOPE_ARG("bench", "bench", "i", i);
+                }
+                ns += std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+                n += BATCH;
+                tracer.flush();
+            }
+            per_event.push_back(ns / n);
+            events += n;
+        }
+        tracer.stop();
+        if (tracer.stats().dropped)
+            std::fprintf(stderr, "trace/scope_on: %llu events dropped\n",
+                         static_cast<unsigned long long>(tracer.stats().dropped));
+        std::remove(path.c_str());
+        std::sort(per_event.begin(), per_event.end());
+        Result r;
+        r.name = "trace/scope_on";
+        r.unit = "ns/op";
+        r.value = per_event[SAMPLES / 2];
+        r.min = per_event.front();
+        r.iterations = events;
+        out.push_back(r);
+    }
+#else
+    (void)opt;
+    (void)out;
+#endif
+}
+
+void bench_kinematics(const Options& opt, std::vector<Result>& out) {
+    const std::string name = "kinematics/update_score_8p";
+    if (!selected(opt, name)) return;
+    constexpr int PEOPLE = 8;
+    constexpr int FRAMES = 64;
+    std::vector<std::vector<RealSenseID::PersonPose>> clip(FRAMES, std::vector<RealSenseID::PersonPose>(PEOPLE));
+    for (int f = 0; f < FRAMES; f++)
+        for (int p = 0; p < PEOPLE; p++) simonsays::synth_pose(clip[f][p], p, f / 30.0);
+    simonsays::KinematicsBatch kinematics(PEOPLE);
+    simonsays::ScoringEngine scoring({}, PEOPLE);
+    uint64_t frame = 0;
+    out.push_back(measure(name, opt.min_time_sec, [&]() {
+        kinematics.update(clip[frame % FRAMES], 1.0f / 30.0f);
+        scoring.update(kinematics, frame / 30.0);
+        ++frame;
+        return static_cast<uint64_t>(scoring.score(0).total);
+    }));
+}
+
+void bench_sign_helper(const Options& opt, std::vector<Result>& out) {
+#ifdef RSID_SECURE
+    RealSenseID::Samples::SignHelper signer;
+    // Verify checks against the device key; use the host key so host signatures verify.
+    signer.UpdateDevicePubKey(signer.GetHostPubKey());
+    unsigned char payload[256];
+    for (size_t i = 0; i < sizeof(payload); i++) payload[i] = static_cast<unsigned char>(i * 31);
+    unsigned char sig[64];
+    if (!signer.Sign(payload, sizeof(payload), sig) || !signer.Verify(payload, sizeof(payload), sig, sizeof(sig))) {
+        std::fprintf(stderr, "SignHelper self-check failed; skipping sign/verify benchmarks\n");
+        return;
+    }
+    if (selected(opt, "sign_helper/sign")) {
+        out.push_back(measure("sign_helper/sign", opt.min_time_sec, [&]() {
+            return static_cast<uint64_t>(signer.Sign(payload, sizeof(payload), sig));
+        }));
+    }
+    if (selected(opt, "sign_helper/verify")) {
+        out.push_back(measure("sign_helper/verify", opt.min_time_sec, [&]() {
+            return static_cast<uint64_t>(signer.Verify(payload, sizeof(payload), sig, sizeof(sig)));
+        }));
+    }
+#else
+    (void)opt;
+    (void)out;
+#endif
+}
+
+// ---- End to end ----
+
+// A single measured value (not ns/op), e.g. a latency percentile or CPU share.
+Result gauge(const char* name, const char* unit, double value, uint64_t samples, bool lower_is_better) {
+    Result r;
+    r.name = name;
+    r.unit = unit;
+    r.value = r.min = value;
+    r.iterations = samples;
+    r.lower_is_better = lower_is_better;
+    return r;
+}
+
+// The app's device session, pipeline, scoring and render loop against a FakeDevice with
+// shortened re-auth, for a fixed time. Render is offscreen (SDL software or transform only).
+void bench_e2e(const Options& opt, std::vector<Result>& out) {
+    if (!selected(opt, "e2e/")) return;
+    simonsays::FakeDeviceConfig device_config;
+    device_config.persons = 2;
+    simonsays::FakeDevice device(device_config);
+    simonsays::Runtime runtime;
+    simonsays::PoseWatchdog watchdog;
+    simonsays::PosePipeline pipeline(watchdog);
+    std::atomic<bool> authenticated{true};
+    simonsays::PoseStreamCallback pose_cb(watchdog, pipeline, authenticated);
+
+    simonsays::KinematicsBatch kinematics;
+    simonsays::ScoringEngine scoring;
+    const auto start = Clock::now();
+    unsigned int last_ts = 0;
+    pipeline.set_frame_handler([&](const simonsays::PoseFrame& frame) {
+        float dt = last_ts && frame.device_ts > last_ts ? (frame.device_ts - last_ts) / 1000.0f : 0.0f;
+        last_ts = frame.device_ts;
+        kinematics.update(frame.poses, dt);
+        scoring.update(kinematics, std::chrono::duration<double>(frame.arrival - start).count());
+    });
+
+    simonsays::SessionConfig session_config;
+    session_config.reauth_interval = std::chrono::seconds(2);
+    simonsays::PoseSession<simonsays::FakeDevice> session(device, runtime, watchdog, pose_cb, RealSenseID::DeviceConfig{},
+                                                          authenticated, session_config);
+    runtime.on_quit([&]() {
+        pipeline.close();
+        device.Cancel();
+    });
+
+    double cpu0 = simonsays::process_cpu_seconds();
+    pipeline.start();
+    runtime.start();
+    session.start();
+
+    simonsays::OffscreenRenderer renderer;
+    std::vector<int64_t> latency_us;
+    double max_gap_ms = 0;
+    Clock::time_point last_render = start;
+    const auto end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opt.e2e_seconds));
+    simonsays::PoseFrame frame;
+    while (Clock::now() < end) {
+        if (!pipeline.next_frame(frame, std::chrono::milliseconds(33))) continue;
+        renderer.render(frame.poses);
+        auto now = Clock::now();
+        latency_us.push_back(std::chrono::duration_cast<std::chrono::microseconds>(now - frame.arrival).count());
+        max_gap_ms = std::max(max_gap_ms, std::chrono::duration<double, std::milli>(now - last_render).count());
+        last_render = now;
+    }
+
+    runtime.request_quit();
+    session.stop();
+    pipeline.join();
+    runtime.stop();
+    double wall = std::chrono::duration<double>(Clock::now() - start).count();
+    double cpu = simonsays::process_cpu_seconds() - cpu0;
+
+    const uint64_t frames = latency_us.size();
+    out.push_back(gauge("e2e/latency_p50", "us", static_cast<double>(simonsays::percentile(latency_us, 0.50)), frames, true));
+    out.push_back(gauge("e2e/latency_p99", "us", static_cast<double>(simonsays::percentile(latency_us, 0.99)), frames, true));
+    out.push_back(gauge("e2e/max_frame_gap", "ms", max_gap_ms, frames, true));
+    out.push_back(gauge("e2e/render_rate", "fps", frames / opt.e2e_seconds, frames, false));
+    out.push_back(gauge("e2e/dropped", "frames",
+                        static_cast<double>(pipeline.dropped() + watchdog.stats(Clock::now()).stale_dropped), frames, true));
+    out.push_back(gauge("e2e/cpu", "%", 100.0 * cpu / wall, frames, true));
+    simonsays::SessionStats ss = session.stats();
+    std::printf("e2e: %llu frames from device, %llu rendered, %llu re-auths\n",
+                static_cast<unsigned long long>(device.frames_sent()), static_cast<unsigned long long>(frames),
+                static_cast<unsigned long long>(ss.reauths));
+}
+
+// Presence-driven idle: the player leaves, the session goes idle (duty-cycled probes, renderer
+// blocked), then comes back. Measures CPU and device streaming share while idle, and the wake-up
+// latency from the player reappearing to the first rendered frame.
+void bench_idle(const Options& opt, std::vector<Result>& out) {
+    if (!selected(opt, "idle/")) return;
+    constexpr int CYCLES = 3;
+    const auto active_hold = std::chrono::seconds(1);
+    const auto idle_hold = std::chrono::milliseconds(1500);
+
+    simonsays::FakeDevice device;
+    simonsays::Runtime runtime;
+    simonsays::PoseWatchdog watchdog;
+    simonsays::PosePipeline pipeline(watchdog);
+    std::atomic<bool> authenticated{true};
+    simonsays::PresenceConfig presence_config;
+    presence_config.idle_after = std::chrono::seconds(1);
+    presence_config.probe_period = std::chrono::milliseconds(500);
+    presence_config.probe_window = std::chrono::milliseconds(200);
+    simonsays::PresenceMonitor presence(presence_config);
+    simonsays::PoseStreamCallback pose_cb(watchdog, pipeline, authenticated, &presence);
+    simonsays::SessionConfig session_config;
+    session_config.reauth_interval = std::chrono::seconds(5);
+    simonsays::PoseSession<simonsays::FakeDevice> session(device, runtime, watchdog, pose_cb, RealSenseID::DeviceConfig{},
+                                                          authenticated, session_config, &presence);
+    runtime.on_quit([&]() {
+        pipeline.close();
+        presence.close();
+        device.Cancel();
+    });
+    pipeline.start();
+    runtime.start();
+    session.start();
+
+    // Render stage as in the app: blocks while idle, otherwise draws each frame.
+    std::atomic<int64_t> person_back_at{0};  // Clock ticks; 0 = not waiting for a wake-up
+    std::vector<int64_t> wake_us;
+    std::thread render([&]() {
+        simonsays::OffscreenRenderer renderer;
+        simonsays::PoseFrame frame;
+        while (!runtime.quit_requested()) {
+            if (presence.idle()) {
+                presence.wait_active(std::chrono::seconds(1));
+                continue;
+            }
+            if (!pipeline.next_frame(frame, std::chrono::milliseconds(33)) || frame.poses.empty()) continue;
+            renderer.render(frame.poses);
+            auto now = Clock::now();
+            presence.note_rendered(now);
+            int64_t back = person_back_at.exchange(0);
+            if (back) wake_us.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                                            now - Clock::time_point(Clock::duration(back))).count());
+        }
+    });
+
+    double idle_cpu = 0, idle_wall = 0, idle_streaming = 0;
+    for (int c = 0; c < CYCLES && !runtime.quit_requested(); c++) {
+        device.set_person_present(true);
+        std::this_thread::sleep_for(active_hold);
+        device.set_person_present(false);
+        while (!presence.idle()) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        double cpu0 = simonsays::process_cpu_seconds(), stream0 = device.streaming_seconds();
+        auto t0 = Clock::now();
+        // Stagger the return so it lands at different points of the probe cycle
+        std::this_thread::sleep_for(idle_hold + c * std::chrono::milliseconds(170));
+        idle_wall += std::chrono::duration<double>(Clock::now() - t0).count();
+        idle_cpu += simonsays::process_cpu_seconds() - cpu0;
+        idle_streaming += device.streaming_seconds() - stream0;
+        person_back_at = Clock::now().time_since_epoch().count();
+        device.set_person_present(true);
+        while (person_back_at.load()) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    runtime.request_quit();
+    render.join();
+    session.stop();
+    pipeline.join();
+    runtime.stop();
+
+    simonsays::PresenceStats ps = presence.stats(Clock::now());
+    const uint64_t n = wake_us.size();
+    out.push_back(gauge("idle/cpu", "%", 100.0 * idle_cpu / idle_wall, CYCLES, true));
+    out.push_back(gauge("idle/active_cpu", "%", ps.active_cpu_percent, CYCLES, true));
+    out.push_back(gauge("idle/device_streaming", "%", 100.0 * idle_streaming / idle_wall, CYCLES, true));
+    out.push_back(gauge("idle/wake_latency_p50", "ms", simonsays::percentile(wake_us, 0.50) / 1000.0, n, true));
+    out.push_back(gauge("idle/wake_latency_max", "ms", simonsays::percentile(wake_us, 1.0) / 1000.0, n, true));
+    std::printf("idle: %llu idle periods, %llu probes, wake-up bound ~%lld ms (probe period)\n",
+                static_cast<unsigned long long>(ps.idle_periods), static_cast<unsigned long long>(session.stats().probes),
+                static_cast<long long>(presence_config.probe_period.count()));
+}
+
+// ---- JSON ----
+
+std::string json_escape(const std::string& s) {
+    std::string o;
+    for (char c : s) {
+        if (c == '"' || c == '\\') o += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20) o += c;
+    }
+    return o;
+}
+
+bool write_json(const std::string& path, const Options& opt, const std::vector<Result>& results) {
+    std::ofstream f(path);
+    if (!f) return false;
+    char when[32] = "";
+    std::time_t now = std::time(nullptr);
+    std::strftime(when, sizeof(when), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+#ifdef SIMONSAYS_NO_SDL
+    const char* render = "transform";
+#else
+    const char* render = "sdl_software";
+#endif
+    f << "{\n  \"suite\": \"simonsays_bench\",\n  \"schema\": 1,\n  \"label\": \"" << json_escape(opt.label)
+      << "\",\n  \"time\": \"" << when << "\",\n  \"render\": \"" << render << "\",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        char line[512];
+        std::snprintf(line, sizeof(line),
+                      "    {\"name\": \"%s\", \"unit\": \"%s\", \"value\": %.3f, \"min\": %.3f, \"iterations\": %llu, "
+                      "\"better\": \"%s\"}%s\n",
+                      json_escape(r.name).c_str(), json_escape(r.unit).c_str(), r.value, r.min,
+                      static_cast<unsigned long long>(r.iterations), r.lower_is_better ? "lower" : "higher",
+                      i + 1 < results.size() ? "," : "");
+        f << line;
+    }
+    f << "  ]\n}\n";
+    return static_cast<bool>(f);
+}
+
+// Reads name -> value back from a file written by write_json.
+bool read_json(const std::string& path, std::map<std::string, double>& out) {
+    std::ifstream f(path);
+    if (!f) return false;
+    std::string line;
+    while (std::getline(f, line)) {
+        const char* key = "\"name\": \"";
+        size_t n = line.find(key);
+        size_t v = line.find("\"value\": ");
+        if (n == std::string::npos || v == std::string::npos) continue;
+        n += std::strlen(key);
+        size_t e = line.find('"', n);
+        if (e == std::string::npos) continue;
+        out[line.substr(n, e - n)] = std::atof(line.c_str() + v + 9);
+    }
+    return true;
+}
+
+// Prints the change against the baseline; returns the number of regressions past the threshold.
+int compare(const std::map<std::string, double>& baseline, const std::vector<Result>& results, double threshold_pct) {
+    int regressions = 0;
+    std::printf("\n%-36s %14s %14s %9s\n", "compare", "baseline", "current", "change");
+    for (const Result& r : results) {
+        auto it = baseline.find(r.name);
+        if (it == baseline.end() || it->second == 0) continue;
+        double change = 100.0 * (r.value - it->second) / it->second;
+        double worse = r.lower_is_better ? change : -change;
+        bool regressed = worse > threshold_pct;
+        regressions += regressed;
+        std::printf("%-36s %14.1f %14.1f %+8.1f%%%s\n", r.name.c_str(), it->second, r.value, change,
+                    regressed ? "  REGRESSION" : "");
+    }
+    return regressions;
+}
+
+bool parse_args(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto value = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+        const char* v = nullptr;
+        if (a == "--filter" && (v = value())) {
+            opt.filter = v;
+        } else if (a == "--min-time" && (v = value())) {
+            opt.min_time_sec = std::atof(v);
+        } else if (a == "--e2e-seconds" && (v = value())) {
+            opt.e2e_seconds = std::atof(v);
+        } else if (a == "--label" && (v = value())) {
+            opt.label = v;
+        } else if (a == "--json" && (v = value())) {
+            opt.json_path = v;
+        } else if (a == "--compare" && (v = value())) {
+            opt.compare_path = v;
+        } else if (a == "--threshold" && (v = value())) {
+            opt.threshold_pct = std::atof(v);
+        } else if (a == "--trace" && (v = value())) {
+            opt.trace_path = v;
+        } else {
+            return false;
+        }
+    }
+    return opt.min_time_sec > 0 && opt.e2e_seconds > 0 && opt.threshold_pct >= 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse_args(argc, argv, opt)) {
+        std::fprintf(stderr, "Usage: %s [--filter TEXT] [--min-time SEC] [--e2e-seconds SEC] [--label TEXT] "
+                             "[--json FILE] [--compare FILE] [--threshold PCT] [--trace FILE]\n", argv[0]);
+        return 1;
+    }
+
+    std::map<std::string, double> baseline;
+    if (!opt.compare_path.empty() && !read_json(opt.compare_path, baseline)) {
+        std::fprintf(stderr, "Cannot read baseline %s\n", opt.compare_path.c_str());
+        return 1;
+    }
+
+    std::vector<Result> results;
+    auto run = [&](void (*bench)(const Options&, std::vector<Result>&)) {
+        size_t before = results.size();
+        bench(opt, results);
+        for (size_t i = before; i < results.size(); i++) print_result(results[i]);
+    };
+    for (auto* bench : {bench_stick_man, bench_device_select, bench_pose_handoff, bench_metrics, bench_trace,
+                        bench_kinematics, bench_sign_helper})
+        run(bench);
+
+    // Only the end-to-end runs are traced; micro-benchmarks would just fill the rings.
+    const bool tracing = !opt.trace_path.empty() && simonsays::Tracer::instance().start(opt.trace_path);
+    if (!opt.trace_path.empty() && !tracing) std::fprintf(stderr, "Cannot write trace to %s\n", opt.trace_path.c_str());
+    SIMONSAYS_TRACE_THREAD_NAME("bench / render");
+    for (auto* bench : {bench_e2e, bench_idle}) run(bench);
+    if (tracing) {
+        simonsays::Tracer::instance().stop();
+        simonsays::TraceStats ts = simonsays::Tracer::instance().stats();
+        std::printf("Trace: %llu events (%llu dropped) written to %s\n", static_cast<unsigned long long>(ts.events),
+                    static_cast<unsigned long long>(ts.dropped), opt.trace_path.c_str());
+    }
+
+    if (!opt.json_path.empty()) {
+        if (!write_json(opt.json_path, opt, results)) {
+            std::fprintf(stderr, "Cannot write %s\n", opt.json_path.c_str());
+            return 1;
+        }
+        std::printf("Wrote %zu results to %s\n", results.size(), opt.json_path.c_str());
+    }
+    if (!baseline.empty() && compare(baseline, results, opt.threshold_pct) > 0) return 2;
+    return 0;
+}
@@ -0,0 +1,55 @@
+// Simon Says: which RealSense ID device to open (see device_select.h).
+
+#include "device_select.h"
+
+#include <cstring>
+
+namespace simonsays {
+
+namespace {
+
+RealSenseID::DeviceType known_or_f46x(RealSenseID::DeviceType type) {
+    return type == RealSenseID::DeviceType::Unknown ? RealSenseID::DeviceType::F46x : type;
+}
+
+} // namespace
+
+bool select_rsid_device(const std::vector<RealSenseID::DeviceInfo>& devices, const char* env_port,
+                        DeviceTypeProbe probe_type, std::string& out_port, RealSenseID::DeviceType& out_type) {
+    if (env_port) {
+        for (const auto& d : devices) {
+            if (std::strcmp(d.serialPort, env_port) == 0) {
+                out_port = d.serialPort;
+                out_type = known_or_f46x(d.deviceType);
+                return true;
+            }
+        }
+        out_port = env_port;
+        out_type = known_or_f46x(probe_type ? probe_type(env_port) : RealSenseID::DeviceType::Unknown);
+        return true;
+    }
+    if (devices.empty()) {
+#ifdef _WIN32
+        out_port = "COM4";
+#else
+        out_port = "/dev/ttyACM0";
+#endif
+        out_type = RealSenseID::DeviceType::F46x;
+        return true;
+    }
+    // Prefer F460 (F46x), then F45x, then any
+    const auto* chosen = &devices[0];
+    for (const auto& d : devices) {
+        if (d.deviceType == RealSenseID::DeviceType::F46x) {
+            chosen = &d;
+            break;
+        }
+        if (chosen->deviceType != RealSenseID::DeviceType::F46x && d.deviceType == RealSenseID::DeviceType::F45x)
+            chosen = &d;
+    }
+    out_port = chosen->serialPort;
+    out_type = known_or_f46x(chosen->deviceType);
+    return true;
+}
+
+} // namespace simonsays
@@ -0,0 +1,22 @@
+// Simon Says: which RealSense ID device to open.
+// Pure selection over an already-discovered device list, so it can be linked and benchmarked
+// without the SDK's serial enumeration.
+
+#pragma once
+
+#include "RealSenseID/DiscoverDevices.h"
+
+#include <string>
+#include <vector>
+
+namespace simonsays {
+
+using DeviceTypeProbe = RealSenseID::DeviceType (*)(const char* port);
+
+// env_port (RSID_PORT) wins; its type comes from the discovered list, else from probe_type.
+// Otherwise prefer F460 (F46x), then F45x, then any. With nothing discovered, falls back to the
+// platform default port. When the type is Unknown (e.g. "Cannot detect device type"), assume F46x.
+bool select_rsid_device(const std::vector<RealSenseID::DeviceInfo>& devices, const char* env_port,
+                        DeviceTypeProbe probe_type, std::string& out_port, RealSenseID::DeviceType& out_type);
+
+} // namespace simonsays
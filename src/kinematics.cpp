@@ -0,0 +1,106 @@
+// Simon Says: per-limb kinematics (see kinematics.h).
+
+#include "kinematics.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace simonsays {
+
+namespace {
+
+constexpr float TWO_PI_F = 6.28318531f;
+
+// The per-limb work is split into two loops over people so each stays simple enough for the
+// vectorizer's if-conversion; __restrict lets it skip runtime alias checks.
+void limb_atan2(size_t n, const float* __restrict xa, const float* __restrict ya, const float* __restrict xb,
+                const float* __restrict yb, float* __restrict out) {
+    for (size_t p = 0; p < n; p++)
+        out[p] = fast_atan2(yb[p] - ya[p], xb[p] - xa[p]);
+}
+
+// v and hv are 0/1 masks, so selects are written as blends and every load is unconditional.
+void limb_rates(size_t n, float inv_dt, float has_dt, const float* __restrict ang_new,
+                const float* __restrict xa, const float* __restrict ya, const float* __restrict xb,
+                const float* __restrict yb, const float* __restrict sa, const float* __restrict sb,
+                float* __restrict ang, float* __restrict vel, float* __restrict acc, float* __restrict spd,
+                float* __restrict val, float* __restrict vok, float* __restrict mxp, float* __restrict myp) {
+    for (size_t p = 0; p < n; p++) {
+        const float ang_prev = ang[p], vel_prev = vel[p], mx_prev = mxp[p], my_prev = myp[p];
+        const float v = sa[p] * sb[p];
+        const float hv = v * val[p] * has_dt;  // seen now and on the previous frame
+        const float mx = 0.5f * (xa[p] + xb[p]);
+        const float my = 0.5f * (ya[p] + yb[p]);
+
+        float d = ang_new[p] - ang_prev;
+        d = d > PI_F ? d - TWO_PI_F : d;  // both angles are in [-pi, pi], so one wrap is enough
+        d = d < -PI_F ? d + TWO_PI_F : d;
+        const float w = d * inv_dt * hv;
+        const float al = (w - vel_prev) * inv_dt * hv * vok[p];
+        const float dmx = mx - mx_prev, dmy = my - my_prev;
+        const float sp = std::sqrt(dmx * dmx + dmy * dmy) * inv_dt * hv;
+
+        ang[p] = ang_prev + v * (ang_new[p] - ang_prev);
+        mxp[p] = mx_prev + v * (mx - mx_prev);
+        myp[p] = my_prev + v * (my - my_prev);
+        vel[p] = w;
+        acc[p] = al;
+        spd[p] = sp;
+        vok[p] = hv;
+        val[p] = v;
+    }
+}
+
+} // namespace
+
+KinematicsBatch::KinematicsBatch(size_t max_people)
+    : _stride(max_people ? max_people : 1),
+      _x(NUM_POSE_LANDMARKS * _stride), _y(NUM_POSE_LANDMARKS * _stride), _seen(NUM_POSE_LANDMARKS * _stride),
+      _angle(NUM_LIMBS * _stride), _ang_vel(NUM_LIMBS * _stride), _ang_acc(NUM_LIMBS * _stride),
+      _speed(NUM_LIMBS * _stride), _valid(NUM_LIMBS * _stride), _vel_ok(NUM_LIMBS * _stride),
+      _mid_x(NUM_LIMBS * _stride), _mid_y(NUM_LIMBS * _stride), _scratch(_stride) {}
+
+void KinematicsBatch::reset() {
+    for (auto* v : {&_angle, &_ang_vel, &_ang_acc, &_speed, &_valid, &_vel_ok, &_mid_x, &_mid_y})
+        std::fill(v->begin(), v->end(), 0.0f);
+    _people = 0;
+}
+
+void KinematicsBatch::update(const std::vector<RealSenseID::PersonPose>& poses, float dt) {
+    const size_t n = std::min(poses.size(), _stride);
+    const size_t S = _stride;
+
+    // People who left start fresh if they come back.
+    for (int l = 0; l < NUM_LIMBS; l++) {
+        for (size_t p = n; p < _people; p++) {
+            _valid[l * S + p] = 0.0f;
+            _vel_ok[l * S + p] = 0.0f;
+            _ang_vel[l * S + p] = 0.0f;
+            _ang_acc[l * S + p] = 0.0f;
+            _speed[l * S + p] = 0.0f;
+        }
+    }
+    _people = n;
+
+    for (size_t p = 0; p < n; p++) {
+        const auto& pose = poses[p];
+        for (int k = 0; k < NUM_POSE_LANDMARKS; k++) {
+            _x[k * S + p] = static_cast<float>(pose.lm_x[k]);
+            _y[k * S + p] = static_cast<float>(pose.lm_y[k]);
+            _seen[k * S + p] = (pose.lm_x[k] != 0 || pose.lm_y[k] != 0) ? 1.0f : 0.0f;
+        }
+    }
+
+    const float inv_dt = dt > 0.0f ? 1.0f / dt : 0.0f;
+    const float has_dt = dt > 0.0f ? 1.0f : 0.0f;
+
+    for (int l = 0; l < NUM_LIMBS; l++) {
+        const int a = POSE_CONNECTIONS[l].first, b = POSE_CONNECTIONS[l].second;
+        limb_atan2(n, &_x[a * S], &_y[a * S], &_x[b * S], &_y[b * S], _scratch.data());
+        limb_rates(n, inv_dt, has_dt, _scratch.data(), &_x[a * S], &_y[a * S], &_x[b * S], &_y[b * S],
+                   &_seen[a * S], &_seen[b * S], &_angle[l * S], &_ang_vel[l * S], &_ang_acc[l * S],
+                   &_speed[l * S], &_valid[l * S], &_vel_ok[l * S], &_mid_x[l * S], &_mid_y[l * S]);
+    }
+}
+
+} // namespace simonsays
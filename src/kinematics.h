@@ -0,0 +1,67 @@
+// Simon Says: per-limb kinematics for every person, every frame.
+// Data is kept structure-of-arrays ([limb][person], [keypoint][person]) so each limb is one
+// contiguous, branch-free loop across people that the compiler can vectorize.
+
+#pragma once
+
+#include "RealSenseID/FaceAuthenticator.h"
+#include "pose_model.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace simonsays {
+
+// The first 12 POSE_CONNECTIONS are body limbs (legs, hips, torso sides, shoulders, arms);
+// the rest are face links and are not scored.
+constexpr int NUM_LIMBS = 12;
+static_assert(NUM_LIMBS <= static_cast<int>(NUM_POSE_CONNECTIONS), "limbs come from POSE_CONNECTIONS");
+
+constexpr float PI_F = 3.14159265f;
+
+// Branch-free atan2 (max error ~2e-4 rad, about 0.01 degrees) that vectorizes, unlike std::atan2.
+inline float fast_atan2(float y, float x) {
+    float ax = x < 0.0f ? -x : x, ay = y < 0.0f ? -y : y;
+    float mx = ax > ay ? ax : ay, mn = ax > ay ? ay : ax;
+    float a = mn / (mx + 1e-30f);
+    float s = a * a;
+    float r = ((-0.0464964749f * s + 0.15931422f) * s - 0.327622764f) * s * a + a;
+    r = ay > ax ? 0.5f * PI_F - r : r;
+    r = x < 0.0f ? PI_F - r : r;
+    return y < 0.0f ? -r : r;
+}
+
+class KinematicsBatch {
+public:
+    explicit KinematicsBatch(size_t max_people = 8);
+
+    // Loads the poses of one frame. dt is seconds since the previous update (<= 0 for the first
+    // frame). People are matched by index; anyone new, or beyond a change in count, starts with
+    // zero velocity. People beyond max_people are ignored.
+    void update(const std::vector<RealSenseID::PersonPose>& poses, float dt);
+    void reset();
+
+    size_t people() const { return _people; }
+    size_t max_people() const { return _stride; }
+
+    // Per limb, indexed by person. Angle is the direction of the vector from POSE_CONNECTIONS
+    // first -> second keypoint in camera pixels (y down), in radians (-pi, pi].
+    const float* angle(int limb) const { return &_angle[limb * _stride]; }
+    const float* angular_velocity(int limb) const { return &_ang_vel[limb * _stride]; }      // rad/s
+    const float* angular_acceleration(int limb) const { return &_ang_acc[limb * _stride]; }  // rad/s^2
+    const float* limb_speed(int limb) const { return &_speed[limb * _stride]; }              // px/s of the limb midpoint
+    // 1 when both keypoints were seen this frame, else 0 (angle then holds its last value and the
+    // rates are 0). Rates also stay 0 until the limb has been seen on consecutive frames.
+    const float* valid(int limb) const { return &_valid[limb * _stride]; }
+
+private:
+    size_t _stride;
+    size_t _people = 0;
+    std::vector<float> _x, _y, _seen;  // [keypoint][person]
+    std::vector<float> _angle, _ang_vel, _ang_acc, _speed, _valid;
+    std::vector<float> _vel_ok;         // angular velocity of the previous frame is meaningful
+    std::vector<float> _mid_x, _mid_y;  // limb midpoints of the last valid frame
+    std::vector<float> _scratch;        // per person, one limb at a time
+};
+
+} // namespace simonsays
@@ -9,13 +9,28 @@
 #include "RealSenseID/FacePose.h"
 #include "RealSenseID/DiscoverDevices.h"
 #include "RealSenseID/Version.h"
+#include "device_select.h"
+#include "kinematics.h"
+#include "metrics.h"
+#include "metrics_http.h"
+#include "pose_pipeline.h"
+#include "pose_session.h"
+#include "presence.h"
+#include "runtime.h"
+#include "scoring.h"
+#include "stick_man.h"
+#include "trace.h"
+#include "watchdog.h"
 #ifdef RSID_SECURE
 #include "secure_mode_helper.h"
 #include <fstream>
 #endif
+#include <algorithm>
 #include <atomic>
 #include <csignal>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <chrono>
 #include <condition_variable>
 #include <iostream>
@@ -39,75 +54,86 @@
 
 namespace {
 
+using simonsays::POSE_WINDOW_W;
+using simonsays::POSE_WINDOW_H;
+
 const char* DEFAULT_USER_ID = "player1";
-constexpr int POSE_WINDOW_W = 640;
-constexpr int POSE_WINDOW_H = 480;
-// Camera frame size used by RealSense ID for pose (FHD)
-constexpr double CAM_WIDTH = 1920.0;
-constexpr double CAM_HEIGHT = 1080.0;
-
-// COCO keypoints: 0=Nose, 1=LeftEye, 2=RightEye, 3=LeftEar, 4=RightEar,
-// 5=LeftShoulder, 6=RightShoulder, 7=LeftElbow, 8=RightElbow, 9=LeftWrist, 10=RightWrist,
-// 11=LeftHip, 12=RightHip, 13=LeftKnee, 14=RightKnee, 15=LeftAnkle, 16=RightAnkle
-const std::vector<std::pair<int, int>> POSE_CONNECTIONS = {
-    {15, 13}, {13, 11}, {16, 14}, {14, 12}, {11, 12}, {5, 11}, {6, 12},
-    {5, 6},   {5, 7},   {7, 9},   {6, 8},   {8, 10},  {0, 1},  {0, 2}, {1, 3}, {2, 4}
-};
 
 // Auto-detect RealSense ID (prefer F460/F46x). RSID_PORT overrides.
-// When type is Unknown (e.g. "Cannot detect device type"), assume F460 (F46x).
 bool discover_rsid_device(std::string& out_port, RealSenseID::DeviceType& out_type) {
     const char* env = std::getenv("RSID_PORT");
-    std::vector<RealSenseID::DeviceInfo> devices = RealSenseID::DiscoverDevices();
-    if (devices.empty()) {
-        if (env) {
-            out_port = env;
-            out_type = RealSenseID::DiscoverDeviceType(out_port.c_str());
-            if (out_type == RealSenseID::DeviceType::Unknown)
-                out_type = RealSenseID::DeviceType::F46x;  // assume F460
-            return true;
-        }
-#ifdef _WIN32
-        out_port = "COM4";
-        out_type = RealSenseID::DeviceType::F46x;
-        return true;
-#else
-        out_port = "/dev/ttyACM0";
-        out_type = RealSenseID::DeviceType::F46x;
-        return true;
-#endif
+    return simonsays::select_rsid_device(RealSenseID::DiscoverDevices(), env, RealSenseID::DiscoverDeviceType,
+                                         out_port, out_type);
+}
+
+// Watchdog tuning; SIMONSAYS_FRAME_DEADLINE_MS and SIMONSAYS_STALL_MS override the defaults.
+simonsays::WatchdogConfig watchdog_config_from_env() {
+    simonsays::WatchdogConfig c;
+    if (const char* v = std::getenv("SIMONSAYS_FRAME_DEADLINE_MS"))
+        c.frame_deadline = std::chrono::milliseconds(std::atoi(v));
+    if (const char* v = std::getenv("SIMONSAYS_STALL_MS"))
+        c.stall_timeout = std::chrono::milliseconds(std::atoi(v));
+    return c;
+}
+
+// Idle tuning; SIMONSAYS_IDLE_AFTER_MS (0 = never idle on an empty scene) and SIMONSAYS_IDLE_PROBE_MS
+// (how often to look for a player while idle, i.e. the wake-up bound) override the defaults.
+simonsays::PresenceConfig presence_config_from_env() {
+    simonsays::PresenceConfig c;
+    if (const char* v = std::getenv("SIMONSAYS_IDLE_AFTER_MS"))
+        c.idle_after = std::chrono::milliseconds(std::atoi(v));
+    if (const char* v = std::getenv("SIMONSAYS_IDLE_PROBE_MS")) {
+        int ms = std::atoi(v);
+        if (ms > 0) c.probe_period = std::chrono::milliseconds(ms);
+        c.probe_window = std::min(c.probe_window, c.probe_period);
     }
-    if (env) {
-        for (const auto& d : devices) {
-            if (std::string(d.serialPort) == env) {
-                out_port = d.serialPort;
-                out_type = d.deviceType;
-                if (out_type == RealSenseID::DeviceType::Unknown)
-                    out_type = RealSenseID::DeviceType::F46x;
-                return true;
-            }
-        }
-        out_port = env;
-        out_type = RealSenseID::DiscoverDeviceType(out_port.c_str());
-        if (out_type == RealSenseID::DeviceType::Unknown)
-            out_type = RealSenseID::DeviceType::F46x;
-        return true;
-    }
-    // Prefer F460 (F46x), then F45x, then any
-    const auto* chosen = &devices[0];
-    for (const auto& d : devices) {
-        if (d.deviceType == RealSenseID::DeviceType::F46x) {
-            chosen = &d;
-            break;
-        }
-        if (chosen->deviceType != RealSenseID::DeviceType::F46x && d.deviceType == RealSenseID::DeviceType::F45x)
-            chosen = &d;
+    return c;
+}
+
+// Metrics export, both optional: SIMONSAYS_METRICS_FILE is rewritten with a Prometheus text
+// snapshot every SIMONSAYS_METRICS_INTERVAL_MS (default 15000); SIMONSAYS_METRICS_PORT serves
+// GET /metrics on SIMONSAYS_METRICS_ADDR (default 127.0.0.1; 0.0.0.0 for remote scrapes).
+struct MetricsExportConfig {
+    std::string file;
+    std::chrono::milliseconds interval{15000};
+    std::string address = "127.0.0.1";
+    uint16_t port = 0;
+};
+
+MetricsExportConfig metrics_export_from_env() {
+    MetricsExportConfig c;
+    if (const char* v = std::getenv("SIMONSAYS_METRICS_FILE")) c.file = v;
+    if (const char* v = std::getenv("SIMONSAYS_METRICS_INTERVAL_MS")) {
+        int ms = std::atoi(v);
+        if (ms > 0) c.interval = std::chrono::milliseconds(ms);
     }
-    out_port = chosen->serialPort;
-    out_type = chosen->deviceType;
-    if (out_type == RealSenseID::DeviceType::Unknown)
-        out_type = RealSenseID::DeviceType::F46x;  // assume F460 when SDK can't detect
-    return true;
+    if (const char* v = std::getenv("SIMONSAYS_METRICS_ADDR")) c.address = v;
+    if (const char* v = std::getenv("SIMONSAYS_METRICS_PORT")) {
+        int port = std::atoi(v);
+        if (port > 0 && port < 65536) c.port = static_cast<uint16_t>(port);
+    }
+    return c;
+}
+
+#if !defined(SIMONSAYS_NO_SDL) || defined(_WIN32)
+// Render metrics for one presented frame; last is reset while idle so the idle gap is not a frame time.
+void count_rendered_frame(simonsays::AppMetrics& metrics, simonsays::Clock::time_point& last,
+                          simonsays::Clock::time_point now) {
+    metrics.render_frames.inc();
+    if (last != simonsays::Clock::time_point{})
+        metrics.render_frame_seconds.observe(std::chrono::duration<double>(now - last).count());
+    last = now;
+}
+#endif
+
+// Dance scoring tuning; SIMONSAYS_BPM sets the beat the player is scored against.
+simonsays::ScoringConfig scoring_config_from_env() {
+    simonsays::ScoringConfig c;
+    if (const char* v = std::getenv("SIMONSAYS_BPM")) {
+        double bpm = std::atof(v);
+        if (bpm > 0) c.bpm = bpm;
+    }
+    return c;
 }
 
 static std::string g_serial_port_storage;
@@ -160,12 +186,23 @@ bool do_pair(RealSenseID::FaceAuthenticator& authenticator, RealSenseID::Samples
 }
 #endif
 
-// Latest pose from device (thread-safe)
-std::mutex g_pose_mutex;
-std::vector<RealSenseID::PersonPose> g_latest_poses;
 std::atomic<bool> g_authenticated{false};
-std::atomic<bool> g_pose_loop_running{false};
-std::atomic<bool> g_quit{false};
+
+// Executor for timers and quit
+simonsays::Runtime g_runtime;
+// So the GDI window can pull the latest pose
+static simonsays::PosePipeline* g_pipeline_for_window = nullptr;
+// So the window can stop redrawing while idle
+static simonsays::PresenceMonitor* g_presence_for_window = nullptr;
+// So the GDI window can count frames
+static simonsays::AppMetrics* g_metrics_for_window = nullptr;
+// So the GDI window can grey out the stick man on a stall, like the SDL one
+static simonsays::PoseWatchdog* g_watchdog_for_window = nullptr;
+#if defined(_WIN32) && defined(SIMONSAYS_NO_SDL)
+// So wake-up and quit can reach the GDI message loop from other threads
+static std::atomic<HWND> g_stick_man_hwnd{nullptr};
+constexpr UINT WM_APP_POWER = WM_APP + 1;
+#endif
 
 // So Ctrl+C handler can call Cancel() on the SDK
 static RealSenseID::FaceAuthenticator* g_authenticator_for_ctrl_c = nullptr;
@@ -173,7 +210,7 @@ static RealSenseID::FaceAuthenticator* g_authenticator_for_ctrl_c = nullptr;
 #ifdef _WIN32
 BOOL WINAPI ctrl_c_handler(DWORD ctrl_type) {
     if (ctrl_type == CTRL_C_EVENT || ctrl_type == CTRL_BREAK_EVENT) {
-        g_quit = true;
+        g_runtime.request_quit();
         if (g_authenticator_for_ctrl_c)
             g_authenticator_for_ctrl_c->Cancel();
         return TRUE;
@@ -182,22 +219,12 @@ BOOL WINAPI ctrl_c_handler(DWORD ctrl_type) {
 }
 #else
 void ctrl_c_handler(int) {
-    g_quit = true;
+    g_runtime.request_quit();
     if (g_authenticator_for_ctrl_c)
         g_authenticator_for_ctrl_c->Cancel();
 }
 #endif
 
-void update_poses(const std::vector<RealSenseID::PersonPose>& poses) {
-    std::lock_guard<std::mutex> lock(g_pose_mutex);
-    g_latest_poses = poses;
-}
-
-void get_poses_copy(std::vector<RealSenseID::PersonPose>& out) {
-    std::lock_guard<std::mutex> lock(g_pose_mutex);
-    out = g_latest_poses;
-}
-
 // ---- Enrollment ----
 class EnrollCallback : public RealSenseID::EnrollmentCallback {
 public:
@@ -212,31 +239,6 @@ public:
     }
 };
 
-// ---- Auth (single shot) ----
-class AuthCallback : public RealSenseID::AuthenticationCallback {
-public:
-    std::atomic<RealSenseID::AuthenticateStatus> result{RealSenseID::AuthenticateStatus::CameraStarted};
-    std::string authenticated_user_id;
-
-    void OnResult(RealSenseID::AuthenticateStatus status, const char* userId, short) override {
-        result = status;
-        if (userId) authenticated_user_id = userId;
-    }
-    void OnHint(RealSenseID::AuthenticateStatus hint, float) override {
-        (void)hint;
-    }
-};
-
-// ---- Pose loop callback: only update poses when authenticated so stick man freezes when not. ----
-class PoseLoopCallback : public RealSenseID::AuthenticationCallback {
-public:
-    void OnResult(RealSenseID::AuthenticateStatus, const char*, short) override {}
-    void OnHint(RealSenseID::AuthenticateStatus, float) override {}
-    void OnPoseDetected(const std::vector<RealSenseID::PersonPose>& poses, unsigned int) override {
-        if (g_authenticated) update_poses(poses);  // only update when authenticated; otherwise last pose stays (frozen)
-    }
-};
-
 #ifndef SIMONSAYS_NO_SDL
 bool init_sdl(SDL_Window*& window, SDL_Renderer*& renderer) {
     if (SDL_Init(SDL_INIT_VIDEO) != 0) {
@@ -260,67 +262,33 @@ bool init_sdl(SDL_Window*& window, SDL_Renderer*& renderer) {
     }
     return true;
 }
-
-void draw_stick_man(SDL_Renderer* renderer, const std::vector<RealSenseID::PersonPose>& poses) {
-    if (poses.empty()) return;
-    const auto& p = poses[0];
-    double scaleX = POSE_WINDOW_W / CAM_WIDTH;
-    double scaleY = POSE_WINDOW_H / CAM_HEIGHT;
-
-    auto draw_line = [&](int i, int j) {
-        if (i >= NUM_POSE_LANDMARKS || j >= NUM_POSE_LANDMARKS) return;
-        uint32_t x0 = p.lm_x[i], y0 = p.lm_y[i], x1 = p.lm_x[j], y1 = p.lm_y[j];
-        if (x0 == 0 && y0 == 0) return;
-        if (x1 == 0 && y1 == 0) return;
-        SDL_RenderDrawLine(renderer,
-                           static_cast<int>(x0 * scaleX), static_cast<int>(y0 * scaleY),
-                           static_cast<int>(x1 * scaleX), static_cast<int>(y1 * scaleY));
-    };
-
-    SDL_SetRenderDrawColor(renderer, 0, 200, 100, 255);
-    for (const auto& conn : POSE_CONNECTIONS)
-        draw_line(conn.first, conn.second);
-
-    SDL_SetRenderDrawColor(renderer, 255, 220, 0, 255);
-    for (int i = 0; i < NUM_POSE_LANDMARKS; i++) {
-        if (p.lm_x[i] == 0 && p.lm_y[i] == 0) continue;
-        int cx = static_cast<int>(p.lm_x[i] * scaleX);
-        int cy = static_cast<int>(p.lm_y[i] * scaleY);
-        SDL_Rect r = { cx - 4, cy - 4, 8, 8 };
-        SDL_RenderFillRect(renderer, &r);
-    }
-}
 #endif
 
 #ifdef SIMONSAYS_NO_SDL
 #ifdef _WIN32
-void draw_stick_man_gdi(HDC hdc, const std::vector<RealSenseID::PersonPose>& poses) {
+// Same colours as draw_stick_man. stale: the pose stream has stalled (grey). dimmed: idle, so
+// the last pose stays on screen in dark grey (what the SDL window's overlay gives).
+void draw_stick_man_gdi(HDC hdc, const std::vector<RealSenseID::PersonPose>& poses, bool stale = false,
+                        bool dimmed = false) {
     if (poses.empty()) return;
-    const auto& p = poses[0];
-    double scaleX = POSE_WINDOW_W / CAM_WIDTH;
-    double scaleY = POSE_WINDOW_H / CAM_HEIGHT;
-
-    auto draw_line = [&](int i, int j) {
-        if (i >= NUM_POSE_LANDMARKS || j >= NUM_POSE_LANDMARKS) return;
-        uint32_t x0 = p.lm_x[i], y0 = p.lm_y[i], x1 = p.lm_x[j], y1 = p.lm_y[j];
-        if (x0 == 0 && y0 == 0) return;
-        if (x1 == 0 && y1 == 0) return;
-        MoveToEx(hdc, static_cast<int>(x0 * scaleX), static_cast<int>(y0 * scaleY), nullptr);
-        LineTo(hdc, static_cast<int>(x1 * scaleX), static_cast<int>(y1 * scaleY));
-    };
+    SIMONSAYS_TRACE_SCOPE("draw_stick_man", "render");
+    simonsays::StickFigure fig;
+    simonsays::layout_stick_man(poses[0], POSE_WINDOW_W, POSE_WINDOW_H, fig);
 
     SelectObject(hdc, GetStockObject(DC_PEN));
-    SetDCPenColor(hdc, RGB(0, 200, 100));
-    for (const auto& conn : POSE_CONNECTIONS)
-        draw_line(conn.first, conn.second);
+    SetDCPenColor(hdc, dimmed ? RGB(50, 50, 50) : stale ? RGB(110, 110, 110) : RGB(0, 200, 100));
+    for (int i = 0; i < fig.num_lines; i++) {
+        const auto& l = fig.lines[i];
+        MoveToEx(hdc, l.x0, l.y0, nullptr);
+        LineTo(hdc, l.x1, l.y1);
+    }
 
     SelectObject(hdc, GetStockObject(DC_BRUSH));
-    SetDCBrushColor(hdc, RGB(255, 220, 0));
-    SetDCPenColor(hdc, RGB(255, 220, 0));
-    for (int i = 0; i < NUM_POSE_LANDMARKS; i++) {
-        if (p.lm_x[i] == 0 && p.lm_y[i] == 0) continue;
-        int cx = static_cast<int>(p.lm_x[i] * scaleX);
-        int cy = static_cast<int>(p.lm_y[i] * scaleY);
+    const COLORREF joint = dimmed ? RGB(72, 72, 72) : stale ? RGB(160, 160, 160) : RGB(255, 220, 0);
+    SetDCBrushColor(hdc, joint);
+    SetDCPenColor(hdc, joint);
+    for (int i = 0; i < fig.num_joints; i++) {
+        int cx = fig.joints[i].x, cy = fig.joints[i].y;
         Ellipse(hdc, cx - 5, cy - 5, cx + 5, cy + 5);
     }
 }
@@ -328,18 +296,21 @@ void draw_stick_man_gdi(HDC hdc, const std::vector<RealSenseID::PersonPose>& pos
 LRESULT CALLBACK StickManWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
     switch (msg) {
     case WM_PAINT: {
+        SIMONSAYS_TRACE_SCOPE("WM_PAINT", "render");
         PAINTSTRUCT ps;
         HDC hdc = BeginPaint(hwnd, &ps);
         RECT rc;
         GetClientRect(hwnd, &rc);
         FillRect(hdc, &rc, (HBRUSH)GetStockObject(BLACK_BRUSH));
         SetBkMode(hdc, TRANSPARENT);
-        // Always draw stick man (moves when authenticated, frozen on last pose when not)
-        {
-            std::vector<RealSenseID::PersonPose> poses;
-            get_poses_copy(poses);
-            if (!poses.empty()) draw_stick_man_gdi(hdc, poses);
-        }
+        // Draw stick man (moves when authenticated, frozen on last pose when not; dimmed while idle)
+        static simonsays::Clock::time_point last_frame;
+        bool idle = g_presence_for_window && g_presence_for_window->idle();
+        if (idle) last_frame = {};
+        std::vector<RealSenseID::PersonPose> poses;
+        if (g_pipeline_for_window) g_pipeline_for_window->latest(poses);
+        const bool stalled = g_watchdog_for_window && g_watchdog_for_window->stalled();
+        if (!poses.empty()) draw_stick_man_gdi(hdc, poses, stalled, idle);
         // Title on top so it is never covered by the stick man
         RECT textRect = { 0, 4, rc.right, 44 };
         SetTextColor(hdc, RGB(220, 255, 220));
@@ -351,19 +322,34 @@ LRESULT CALLBACK StickManWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPar
         SelectObject(hdc, oldFont);
         DeleteObject(font);
         EndPaint(hwnd, &ps);
+        if (!idle) {
+            auto now = simonsays::Clock::now();
+            if (g_presence_for_window) g_presence_for_window->note_rendered(now);
+            if (g_metrics_for_window) count_rendered_frame(*g_metrics_for_window, last_frame, now);
+        }
         return 0;
     }
     case WM_TIMER:
+        // Idle: paint one static frame and stop the redraw timer until WM_APP_POWER
+        if (g_presence_for_window && g_presence_for_window->idle()) KillTimer(hwnd, 1);
         InvalidateRect(hwnd, nullptr, FALSE);
         return 0;
+    case WM_APP_POWER:
+        if (g_runtime.quit_requested()) {
+            PostQuitMessage(0);
+        } else if (!(g_presence_for_window && g_presence_for_window->idle())) {
+            SetTimer(hwnd, 1, 33, nullptr);
+            InvalidateRect(hwnd, nullptr, FALSE);
+        }
+        return 0;
     case WM_KEYDOWN:
         if (wParam == VK_ESCAPE) {
-            g_quit = true;
+            g_runtime.request_quit();
             PostQuitMessage(0);
         }
         return 0;
     case WM_CLOSE:
-        g_quit = true;
+        g_runtime.request_quit();
         DestroyWindow(hwnd);
         return 0;
     case WM_DESTROY:
@@ -391,12 +377,14 @@ bool run_stick_man_window_win32() {
 
     ShowWindow(hwnd, SW_SHOW);
     SetTimer(hwnd, 1, 33, nullptr);  // ~30 fps redraw
+    g_stick_man_hwnd = hwnd;
 
     MSG msg;
-    while (!g_quit && GetMessage(&msg, nullptr, 0, 0) > 0) {
+    while (!g_runtime.quit_requested() && GetMessage(&msg, nullptr, 0, 0) > 0) {
         TranslateMessage(&msg);
         DispatchMessage(&msg);
     }
+    g_stick_man_hwnd = nullptr;
     KillTimer(hwnd, 1);
     return true;
 }
@@ -406,8 +394,29 @@ bool run_stick_man_window_win32() {
 } // namespace
 
 int main(int argc, char** argv) {
-    (void)argc;
-    (void)argv;
+    // --trace FILE: Chrome trace-event capture of the device, session and render threads.
+    const char* trace_path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--trace out.json]" << std::endl;
+            return 1;
+        }
+    }
+    simonsays::TraceGuard trace_guard;  // closes the trace on every return path below
+    if (trace_path) {
+#ifndef SIMONSAYS_NO_TRACE
+        if (!simonsays::Tracer::instance().start(trace_path)) {
+            std::cerr << "Cannot write trace to " << trace_path << std::endl;
+            return 1;
+        }
+        SIMONSAYS_TRACE_THREAD_NAME("main / render");
+#else
+        std::cerr << "--trace ignored: this build has tracing compiled out (SIMONSAYS_TRACE=OFF)." << std::endl;
+        trace_path = nullptr;
+#endif
+    }
 
 #ifdef _WIN32
     SetConsoleCtrlHandler(ctrl_c_handler, TRUE);
@@ -457,15 +466,42 @@ int main(int argc, char** argv) {
 #else
     RealSenseID::FaceAuthenticator authenticator(device_type);
 #endif
+    // Metrics are always collected (an uncontended atomic add per event); export is opt-in.
+    simonsays::MetricsRegistry metrics_registry;
+    simonsays::AppMetrics metrics(metrics_registry);
+    const MetricsExportConfig metrics_export = metrics_export_from_env();
+
     std::cout << "Connecting..." << std::flush;
-    auto status = authenticator.Connect(get_serial_config(port.c_str()));
+    RealSenseID::Status status;
+    {
+        simonsays::ScopedTimer timer(&metrics.connect_seconds);
+        SIMONSAYS_TRACE_SCOPE("Connect", "device");
+        status = authenticator.Connect(get_serial_config(port.c_str()));
+    }
+    (status == RealSenseID::Status::Ok ? metrics.connect_ok : metrics.connect_failed).inc();
     if (status != RealSenseID::Status::Ok) {
+        if (!metrics_export.file.empty()) metrics_registry.write_prometheus_file(metrics_export.file);
         std::cerr << "Failed to connect: " << static_cast<int>(status) << std::endl;
         std::cerr << "Set RSID_PORT to your device port (e.g. COM9 on Windows)." << std::endl;
         return 1;
     }
     std::cout << " done.\n" << std::endl;
 
+    simonsays::MetricsHttpServer metrics_server(metrics_registry);
+    if (metrics_export.port) {
+        if (metrics_server.start(metrics_export.address, metrics_export.port))
+            std::cout << "Metrics: http://" << metrics_export.address << ":" << metrics_export.port << "/metrics" << std::endl;
+        else
+            std::cerr << "Metrics: cannot listen on " << metrics_export.address << ":" << metrics_export.port << std::endl;
+    }
+    if (!metrics_export.file.empty()) {
+        // Runs once the runtime starts with the pose session.
+        g_runtime.schedule_every(metrics_export.interval, [&]() {
+            if (!metrics_registry.write_prometheus_file(metrics_export.file))
+                std::cerr << "Metrics: cannot write " << metrics_export.file << std::endl;
+        });
+    }
+
 #ifdef RSID_SECURE
     if (need_pair) {
         std::cout << "No device key found. Pairing with device..." << std::endl;
@@ -516,10 +552,18 @@ int main(int argc, char** argv) {
     RealSenseID::DeviceConfig dev_config;
     authenticator.QueryDeviceConfig(dev_config);
     dev_config.algo_flow = RealSenseID::DeviceConfig::AlgoFlow::All;
-    authenticator.SetDeviceConfig(dev_config);
+    {
+        simonsays::ScopedTimer timer(&metrics.set_device_config_seconds);
+        SIMONSAYS_TRACE_SCOPE("SetDeviceConfig", "device");
+        authenticator.SetDeviceConfig(dev_config);
+    }
 
-    AuthCallback auth_cb;
-    status = authenticator.Authenticate(auth_cb);
+    simonsays::AuthResultCallback auth_cb;
+    {
+        simonsays::ScopedTimer timer(&metrics.authenticate_seconds);
+        SIMONSAYS_TRACE_SCOPE("Authenticate", "device");
+        status = authenticator.Authenticate(auth_cb);
+    }
     if (status != RealSenseID::Status::Ok) {
         std::cerr << "Authenticate call failed: " << static_cast<int>(status) << std::endl;
         g_authenticator_for_ctrl_c = nullptr;
@@ -540,73 +584,154 @@ int main(int argc, char** argv) {
     // 3) Pose stream (PoseEstimationOnly) for smooth stick man; re-auth every 10 s so mask/wrong person stops it
     constexpr int REAUTH_INTERVAL_SEC = 10;
     dev_config.algo_flow = RealSenseID::DeviceConfig::AlgoFlow::PoseEstimationOnly;
-    authenticator.SetDeviceConfig(dev_config);
-
-    PoseLoopCallback pose_cb;
-    std::thread pose_thread;
-    std::mutex pose_thread_mutex;
-
-    auto run_pose_loop = [&]() {
-        g_pose_loop_running = true;
-        authenticator.AuthenticateLoop(pose_cb);
-        g_pose_loop_running = false;
+    {
+        simonsays::ScopedTimer timer(&metrics.set_device_config_seconds);
+        SIMONSAYS_TRACE_SCOPE("SetDeviceConfig", "device");
+        authenticator.SetDeviceConfig(dev_config);
+    }
+
+    simonsays::PoseWatchdog watchdog(watchdog_config_from_env());
+    simonsays::PosePipeline pipeline(watchdog);
+    simonsays::PresenceMonitor presence(presence_config_from_env());
+    simonsays::PoseStreamCallback pose_cb(watchdog, pipeline, g_authenticated, &presence, &metrics);
+    // Kinematics and scoring run on the pipeline's processing thread, on admitted frames only.
+    simonsays::KinematicsBatch kinematics;
+    simonsays::ScoringEngine scoring(scoring_config_from_env());
+    const auto dance_start = simonsays::Clock::now();
+    unsigned int last_pose_ts = 0;
+    pipeline.set_frame_handler([&](const simonsays::PoseFrame& frame) {
+        float dt = last_pose_ts && frame.device_ts > last_pose_ts ? (frame.device_ts - last_pose_ts) / 1000.0f : 0.0f;
+        last_pose_ts = frame.device_ts;
+        kinematics.update(frame.poses, dt);
+        scoring.update(kinematics, std::chrono::duration<double>(frame.arrival - dance_start).count());
+    });
+    // All SDK calls from here on run on one persistent device worker; the runtime's timer wheel
+    // triggers re-auth by cancelling the pose loop and queueing the re-auth job behind it.
+    simonsays::SessionConfig session_config;
+    session_config.reauth_interval = std::chrono::seconds(REAUTH_INTERVAL_SEC);
+    simonsays::PoseSession<RealSenseID::FaceAuthenticator> session(authenticator, g_runtime, watchdog, pose_cb,
+                                                                   dev_config, g_authenticated, session_config,
+                                                                   &presence, &metrics);
+    // Values the pipeline, watchdog and presence monitor already track, read at export time.
+    metrics_registry.sampled_counter("simonsays_pose_frames_dropped_total",
+                                     "Pose frames dropped by the processing queue or as stale.", [&]() {
+        return static_cast<double>(pipeline.dropped() + watchdog.stats(simonsays::Clock::now()).stale_dropped);
+    });
+    metrics_registry.sampled_counter("simonsays_watchdog_stalls_total", "Pose stream stalls detected.",
+                                     [&]() { return static_cast<double>(watchdog.stats(simonsays::Clock::now()).stalls); });
+    metrics_registry.sampled_counter("simonsays_watchdog_bursts_total", "Pose callbacks arriving bunched up.",
+                                     [&]() { return static_cast<double>(watchdog.stats(simonsays::Clock::now()).bursts); });
+    metrics_registry.sampled_counter("simonsays_watchdog_backpressure_total",
+                                     "Times the processing queue backed up past the back-pressure depth.", [&]() {
+        return static_cast<double>(watchdog.stats(simonsays::Clock::now()).backpressure);
+    });
+    metrics_registry.gauge("simonsays_pose_age_seconds", "Age of the newest processed pose (0 before the first).",
+                           [&]() { return watchdog.stats(simonsays::Clock::now()).pose_age_ms / 1000.0; });
+    metrics_registry.gauge("simonsays_authenticated", "1 while the player is authenticated.",
+                           []() { return g_authenticated.load() ? 1.0 : 0.0; });
+    metrics_registry.gauge("simonsays_idle", "1 while in the idle power state.",
+                           [&]() { return presence.idle() ? 1.0 : 0.0; });
+    // Wakes a window that is blocked while idle; also used for quit. Presence changes start with
+    // the session, before SDL is initialized, so SDL events are only pushed while the window exists.
+#ifndef SIMONSAYS_NO_SDL
+    std::mutex window_mutex;
+    bool window_ready = false;  // guarded by window_mutex
+#endif
+    auto poke_window = [&]() {
+#ifndef SIMONSAYS_NO_SDL
+        std::lock_guard<std::mutex> lock(window_mutex);
+        if (!window_ready) return;
+        SDL_Event ev = {};
+        ev.type = SDL_USEREVENT;
+        SDL_PushEvent(&ev);
+#elif defined(_WIN32)
+        if (HWND hwnd = g_stick_man_hwnd.load()) PostMessage(hwnd, WM_APP_POWER, 0, 0);
+#endif
     };
+    presence.add_listener([&](simonsays::PowerState) { poke_window(); });
 
-    std::thread reauth_thread([&]() {
-        while (!g_quit) {
-            for (int i = 0; i < REAUTH_INTERVAL_SEC && !g_quit; ++i)
-                std::this_thread::sleep_for(std::chrono::seconds(1));
-            if (g_quit) break;
-            std::lock_guard<std::mutex> lock(pose_thread_mutex);
-            authenticator.Cancel();
-            if (pose_thread.joinable()) pose_thread.join();
-            if (g_quit) break;
-            dev_config.algo_flow = RealSenseID::DeviceConfig::AlgoFlow::All;
-            authenticator.SetDeviceConfig(dev_config);
-            AuthCallback reauth_cb;
-            authenticator.Authenticate(reauth_cb);
-            g_authenticated = (reauth_cb.result == RealSenseID::AuthenticateStatus::Success);
-            dev_config.algo_flow = RealSenseID::DeviceConfig::AlgoFlow::PoseEstimationOnly;
-            authenticator.SetDeviceConfig(dev_config);
-            pose_thread = std::thread(run_pose_loop);
-        }
+    g_runtime.on_quit([&]() {
+        pipeline.close();
+        presence.close();
+        session.cancel();
+        poke_window();
     });
-
-    {
-        std::lock_guard<std::mutex> lock(pose_thread_mutex);
-        pose_thread = std::thread(run_pose_loop);
-    }
+    g_pipeline_for_window = &pipeline;
+    g_presence_for_window = &presence;
+    g_metrics_for_window = &metrics;
+    g_watchdog_for_window = &watchdog;
+    pipeline.start();
+    g_runtime.start();
+    session.start();
 
 #ifndef SIMONSAYS_NO_SDL
     SDL_Window* window = nullptr;
     SDL_Renderer* renderer = nullptr;
     if (!init_sdl(window, renderer)) {
         std::cerr << "SDL init failed; continuing without window." << std::endl;
+    } else {
+        std::lock_guard<std::mutex> lock(window_mutex);
+        window_ready = true;
     }
 
-    while (!g_quit && window) {
+    std::vector<RealSenseID::PersonPose> poses;
+    bool idle_frame_shown = false;
+    simonsays::Clock::time_point last_frame;
+    auto handle_event = [&](const SDL_Event& e) {
+        if (e.type == SDL_QUIT) g_runtime.request_quit();
+        if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE) g_runtime.request_quit();
+        if (e.type == SDL_WINDOWEVENT) idle_frame_shown = false;  // exposed/resized: repaint the idle frame
+    };
+    while (!g_runtime.quit_requested() && window) {
         SDL_Event e;
-        while (SDL_PollEvent(&e)) {
-            if (e.type == SDL_QUIT) g_quit = true;
-            if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE) g_quit = true;
+        if (presence.idle()) {
+            // Idle: one static frame (the last pose, greyed and dimmed), then block until input,
+            // wake-up or quit (no redraw timer)
+            if (!idle_frame_shown) {
+                SDL_SetRenderDrawColor(renderer, 20, 20, 30, 255);
+                SDL_RenderClear(renderer);
+                if (!poses.empty()) simonsays::draw_stick_man(renderer, poses, true);
+                SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+                SDL_SetRenderDrawColor(renderer, 0, 0, 0, 140);
+                SDL_RenderFillRect(renderer, nullptr);
+                SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+                SIMONSAYS_TRACE_SCOPE("SDL_RenderPresent", "render");
+                SDL_RenderPresent(renderer);
+                idle_frame_shown = true;
+            }
+            last_frame = {};
+            if (SDL_WaitEvent(&e)) handle_event(e);
+            continue;
         }
-        if (g_quit) break;
+        idle_frame_shown = false;
+        while (SDL_PollEvent(&e)) handle_event(e);
+        if (g_runtime.quit_requested()) break;
 
         SDL_SetRenderDrawColor(renderer, 20, 20, 30, 255);
         SDL_RenderClear(renderer);
 
         // Always draw stick man (moves when authenticated, frozen on last pose when not)
+        if (!poses.empty()) simonsays::draw_stick_man(renderer, poses, watchdog.stalled());
+
         {
-            std::vector<RealSenseID::PersonPose> poses;
-            get_poses_copy(poses);
-            if (!poses.empty()) draw_stick_man(renderer, poses);
+            SIMONSAYS_TRACE_SCOPE("SDL_RenderPresent", "render");
+            SDL_RenderPresent(renderer);
         }
+        auto presented = simonsays::Clock::now();
+        presence.note_rendered(presented);
+        count_rendered_frame(metrics, last_frame, presented);
 
-        SDL_RenderPresent(renderer);
-        SDL_Delay(33); // ~30 fps
+        // Block until the next frame or ~30 fps redraw; queue close on quit wakes us immediately
+        simonsays::PoseFrame frame;
+        if (pipeline.next_frame(frame, std::chrono::milliseconds(33)))
+            poses = std::move(frame.poses);
     }
 
     if (window) {
+        {
+            std::lock_guard<std::mutex> lock(window_mutex);
+            window_ready = false;
+        }
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
         SDL_Quit();
@@ -619,19 +744,49 @@ int main(int argc, char** argv) {
     std::cout << "Stick man window disabled (no SDL2). Press Enter to exit." << std::endl;
     std::cin.get();
     std::cin.get();
-    g_quit = true;
+    g_runtime.request_quit();
 #endif
 #endif
 
-    g_quit = true;
-    authenticator.Cancel();
-    if (reauth_thread.joinable()) reauth_thread.join();
-    {
-        std::lock_guard<std::mutex> lock(pose_thread_mutex);
-        if (pose_thread.joinable()) pose_thread.join();
-    }
+    g_runtime.request_quit();
+    session.stop();
+    pipeline.join();
+    g_runtime.stop();
+    metrics_server.stop();
+    if (!metrics_export.file.empty()) metrics_registry.write_prometheus_file(metrics_export.file);
+    g_pipeline_for_window = nullptr;
+    g_presence_for_window = nullptr;
+    g_metrics_for_window = nullptr;
+    g_watchdog_for_window = nullptr;
     g_authenticator_for_ctrl_c = nullptr;
     authenticator.Disconnect();
+
+    simonsays::RuntimeStats rs = g_runtime.stats();
+    std::cout << "Runtime: " << rs.wakeups << " wakeups, " << rs.timers_fired << " timers, "
+              << session.stats().device_jobs << " device jobs, " << pipeline.frames() << " frames ("
+              << pipeline.dropped() << " dropped), shutdown "
+              << rs.shutdown_latency.count() / 1000.0 << " ms" << std::endl;
+    simonsays::WatchdogStats ws = watchdog.stats(simonsays::Clock::now());
+    std::cout << "Watchdog: " << ws.stalls << " stalls, " << ws.bursts << " bursts, " << ws.backpressure
+              << " back-pressure, " << ws.stale_dropped << " stale frames dropped, " << ws.restarts
+              << " restarts, max pose age " << ws.max_pose_age_ms << " ms" << std::endl;
+    simonsays::PresenceStats ps = presence.stats(simonsays::Clock::now());
+    std::cout << "Power: " << ps.idle_periods << " idle periods (" << ps.idle_seconds << " s idle, "
+              << ps.active_seconds << " s active), CPU " << ps.idle_cpu_percent << "% idle vs "
+              << ps.active_cpu_percent << "% active, " << session.stats().probes << " idle probes, wake-up "
+              << ps.last_wake_ms << " ms last / " << ps.max_wake_ms << " ms max (probe every "
+              << presence.config().probe_period.count() << " ms)" << std::endl;
+    if (scoring.people() > 0) {
+        const simonsays::DanceScore& ds = scoring.score(0);
+        std::cout << "Dance score: " << static_cast<int>(ds.total + 0.5f) << "/100 (rhythm " << ds.rhythm
+                  << ", extension " << ds.extension << ", energy " << ds.energy << ")" << std::endl;
+    }
+    if (trace_path) {
+        simonsays::Tracer::instance().stop();
+        simonsays::TraceStats ts = simonsays::Tracer::instance().stats();
+        std::cout << "Trace: " << ts.events << " events (" << ts.dropped << " dropped) written to " << trace_path
+                  << std::endl;
+    }
     std::cout << "Done." << std::endl;
     return 0;
 }
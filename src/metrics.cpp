@@ -0,0 +1,187 @@
+// Simon Says: runtime metrics with Prometheus text export (see metrics.h).
+
+#include "metrics.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace simonsays {
+
+namespace {
+
+std::string format_value(double v) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.10g", v);
+    return buf;
+}
+
+// name{labels} or name{labels,extra}; no braces when both are empty.
+std::string series_name(const std::string& name, const std::string& labels, const std::string& extra = "") {
+    if (labels.empty() && extra.empty()) return name;
+    std::string out = name + "{" + labels;
+    if (!labels.empty() && !extra.empty()) out += ",";
+    return out + extra + "}";
+}
+
+} // namespace
+
+size_t next_metric_shard() {
+    static std::atomic<size_t> next{0};
+    return next.fetch_add(1, std::memory_order_relaxed) % METRIC_SHARDS;
+}
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (const auto& s : _shards) total += s.value.load(std::memory_order_relaxed);
+    return total;
+}
+
+Histogram::Histogram(const std::vector<double>& bounds) {
+    if (bounds.size() > MAX_BOUNDS)
+        throw std::invalid_argument("histogram has " + std::to_string(bounds.size()) + " bounds, at most " +
+                                    std::to_string(MAX_BOUNDS) + " are supported");
+    _num_bounds = bounds.size();
+    std::copy(bounds.begin(), bounds.begin() + _num_bounds, _bounds);
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot snap;
+    snap.buckets.assign(_num_bounds + 1, 0);
+    for (const auto& s : _shards) {
+        for (size_t b = 0; b <= _num_bounds; b++) snap.buckets[b] += s.buckets[b].load(std::memory_order_relaxed);
+        snap.sum += s.sum.load(std::memory_order_relaxed);
+    }
+    for (uint64_t n : snap.buckets) snap.count += n;
+    return snap;
+}
+
+MetricsRegistry::Series& MetricsRegistry::series(const std::string& name, const std::string& help, Type type,
+                                                 const std::string& labels) {
+    auto fit = std::find_if(_families.begin(), _families.end(), [&](const auto& f) { return f->name == name; });
+    if (fit == _families.end()) {
+        _families.push_back(std::unique_ptr<Family>(new Family{name, help, type, {}}));
+        fit = _families.end() - 1;
+    } else if ((*fit)->type != type) {
+        throw std::logic_error("metric " + name + " is already registered with another type");
+    }
+    auto& all = (*fit)->series;
+    auto sit = std::find_if(all.begin(), all.end(), [&](const auto& s) { return s->labels == labels; });
+    if (sit != all.end()) return **sit;
+    all.push_back(std::unique_ptr<Series>(new Series{labels, nullptr, nullptr, nullptr}));
+    return *all.back();
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Series& s = series(name, help, Type::Counter, labels);
+    if (s.read) throw std::logic_error("metric " + series_name(name, labels) + " is already a sampled counter");
+    if (!s.counter) s.counter.reset(new Counter());
+    return *s.counter;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                      const std::vector<double>& bounds, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    // Checked before the series exists so a rejected registration leaves nothing behind.
+    if (bounds.size() > Histogram::MAX_BOUNDS)
+        throw std::logic_error("metric " + series_name(name, labels) + " has more than " +
+                               std::to_string(Histogram::MAX_BOUNDS) + " histogram bounds");
+    Series& s = series(name, help, Type::Histogram, labels);
+    if (!s.histogram) s.histogram.reset(new Histogram(bounds));
+    return *s.histogram;
+}
+
+void MetricsRegistry::sampled_counter(const std::string& name, const std::string& help, std::function<double()> read,
+                                      const std::string& labels) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Series& s = series(name, help, Type::Counter, labels);
+    if (s.counter) throw std::logic_error("metric " + series_name(name, labels) + " is already a counter");
+    s.read = std::move(read);
+}
+
+void MetricsRegistry::gauge(const std::string& name, const std::string& help, std::function<double()> read,
+                            const std::string& labels) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    series(name, help, Type::Gauge, labels).read = std::move(read);
+}
+
+std::string MetricsRegistry::prometheus_text() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::string out;
+    out.reserve(4096);
+    for (const auto& f : _families) {
+        out += "# HELP " + f->name + " " + f->help + "\n";
+        const char* type = f->type == Type::Counter ? "counter" : f->type == Type::Gauge ? "gauge" : "histogram";
+        out += "# TYPE " + f->name + " " + type + "\n";
+        for (const auto& s : f->series) {
+            if (s->histogram) {
+                Histogram::Snapshot snap = s->histogram->snapshot();
+                std::vector<double> bounds = s->histogram->bounds();
+                uint64_t cumulative = 0;
+                for (size_t b = 0; b < snap.buckets.size(); b++) {
+                    cumulative += snap.buckets[b];
+                    std::string le = b < bounds.size() ? format_value(bounds[b]) : "+Inf";
+                    out += series_name(f->name + "_bucket", s->labels, "le=\"" + le + "\"") + " " +
+                           std::to_string(cumulative) + "\n";
+                }
+                out += series_name(f->name + "_sum", s->labels) + " " + format_value(snap.sum) + "\n";
+                out += series_name(f->name + "_count", s->labels) + " " + std::to_string(snap.count) + "\n";
+            } else if (s->counter) {
+                out += series_name(f->name, s->labels) + " " + std::to_string(s->counter->value()) + "\n";
+            } else if (s->read) {
+                out += series_name(f->name, s->labels) + " " + format_value(s->read()) + "\n";
+            }
+        }
+    }
+    return out;
+}
+
+bool MetricsRegistry::write_prometheus_file(const std::string& path) const {
+    const std::string text = prometheus_text();
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        if (!f) return false;
+        f << text;
+        if (!f.good()) return false;
+    }
+#ifdef _WIN32
+    // rename does not replace on Windows, and remove + rename leaves a window with no file.
+    return MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+#endif
+}
+
+AppMetrics::AppMetrics(MetricsRegistry& r)
+    : registry(r),
+      pose_callbacks(r.counter("simonsays_pose_callbacks_total", "OnPoseDetected callbacks from the device.")),
+      pose_persons(r.histogram("simonsays_pose_persons", "People per pose callback.", {0, 1, 2, 3, 4, 6, 8})),
+      reauth_success(r.counter("simonsays_reauth_total", "Periodic face re-authentications by result.",
+                               "result=\"success\"")),
+      reauth_failure(r.counter("simonsays_reauth_total", "Periodic face re-authentications by result.",
+                               "result=\"failure\"")),
+      authenticate_seconds(r.histogram("simonsays_authenticate_seconds", "Duration of one-shot Authenticate calls.",
+                                       {0.1, 0.25, 0.5, 0.75, 1, 1.5, 2, 3, 5, 10})),
+      set_device_config_seconds(r.histogram("simonsays_set_device_config_seconds", "SetDeviceConfig round trip.",
+                                            {0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1})),
+      render_frames(r.counter("simonsays_render_frames_total", "Stick man frames presented while active.")),
+      render_frame_seconds(r.histogram("simonsays_render_frame_seconds",
+                                       "Time between presented frames while active.",
+                                       {0.008, 0.016, 0.025, 0.033, 0.05, 0.075, 0.1, 0.25, 0.5, 1})),
+      connect_ok(r.counter("simonsays_connect_total", "Device connection attempts by result.", "result=\"ok\"")),
+      connect_failed(r.counter("simonsays_connect_total", "Device connection attempts by result.",
+                               "result=\"error\"")),
+      connect_seconds(r.histogram("simonsays_connect_seconds", "Duration of Connect.",
+                                  {0.05, 0.1, 0.25, 0.5, 1, 2, 5, 10})) {}
+
+} // namespace simonsays
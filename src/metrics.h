@@ -0,0 +1,165 @@
+// Simon Says: runtime metrics with Prometheus text export.
+// Counters and histograms are sharded: each thread is assigned one of METRIC_SHARDS cache-line
+// aligned slots, so an update on the hot path is a relaxed atomic add to a line that no other busy
+// thread writes. Shards are only summed when a snapshot is exported. Registration takes a lock and
+// happens once at start-up; components keep the returned references.
+
+#pragma once
+
+#include "runtime.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace simonsays {
+
+constexpr size_t METRIC_SHARDS = 16;
+constexpr size_t CACHE_LINE = 64;
+
+size_t next_metric_shard();
+
+// Shard of the calling thread, assigned round-robin on first use.
+inline size_t metric_shard() {
+    thread_local const size_t shard = next_metric_shard();
+    return shard;
+}
+
+class Counter {
+public:
+    void inc(uint64_t n = 1) { _shards[metric_shard()].value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const;
+
+private:
+    struct alignas(CACHE_LINE) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    Shard _shards[METRIC_SHARDS];
+};
+
+// Fixed buckets, chosen at registration; values above the last bound land in +Inf.
+class Histogram {
+public:
+    static constexpr size_t MAX_BOUNDS = 15;
+
+    // bounds: ascending bucket upper bounds (Prometheus "le"), at most MAX_BOUNDS of them; more
+    // throws std::invalid_argument rather than exporting buckets the caller did not ask for.
+    explicit Histogram(const std::vector<double>& bounds);
+
+    void observe(double value) {
+        size_t b = 0;
+        while (b < _num_bounds && value > _bounds[b]) ++b;
+        Shard& s = _shards[metric_shard()];
+        s.buckets[b].fetch_add(1, std::memory_order_relaxed);
+        // Uncontended unless more than METRIC_SHARDS threads observe the same histogram.
+        double sum = s.sum.load(std::memory_order_relaxed);
+        while (!s.sum.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed)) {
+        }
+    }
+
+    struct Snapshot {
+        std::vector<uint64_t> buckets;  // per bucket (not cumulative), +Inf last
+        uint64_t count = 0;
+        double sum = 0;
+    };
+    Snapshot snapshot() const;
+    std::vector<double> bounds() const { return std::vector<double>(_bounds, _bounds + _num_bounds); }
+
+private:
+    struct alignas(CACHE_LINE) Shard {
+        std::atomic<uint64_t> buckets[MAX_BOUNDS + 1] = {};
+        std::atomic<double> sum{0};
+    };
+    double _bounds[MAX_BOUNDS] = {};
+    size_t _num_bounds = 0;
+    Shard _shards[METRIC_SHARDS];
+};
+
+// Observes the seconds from construction to destruction; does nothing without a histogram.
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram* histogram) : _histogram(histogram) {
+        if (_histogram) _start = Clock::now();
+    }
+    ~ScopedTimer() {
+        if (_histogram) _histogram->observe(std::chrono::duration<double>(Clock::now() - _start).count());
+    }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram* _histogram;
+    Clock::time_point _start;
+};
+
+class MetricsRegistry {
+public:
+    // labels is a Prometheus label list without braces, e.g. "result=\"success\"". Registering the
+    // same name and labels again returns the existing metric. Reusing a name for another type, or
+    // a series for another kind of metric (say a counter as a sampled counter), throws
+    // std::logic_error: that is a bug in the registering code, and the export would be invalid.
+    Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+    Histogram& histogram(const std::string& name, const std::string& help, const std::vector<double>& bounds,
+                         const std::string& labels = "");
+    // Read at export time, for values another component already tracks. The read function must
+    // stay valid while exports can run.
+    void sampled_counter(const std::string& name, const std::string& help, std::function<double()> read,
+                         const std::string& labels = "");
+    void gauge(const std::string& name, const std::string& help, std::function<double()> read,
+               const std::string& labels = "");
+
+    // Prometheus text exposition format (0.0.4).
+    std::string prometheus_text() const;
+    // Writes to path via a temporary file and rename, so a scraper (e.g. node_exporter's textfile
+    // collector) never sees a partial file.
+    bool write_prometheus_file(const std::string& path) const;
+
+private:
+    enum class Type { Counter, Gauge, Histogram };
+
+    struct Series {
+        std::string labels;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Histogram> histogram;
+        std::function<double()> read;
+    };
+
+    struct Family {
+        std::string name;
+        std::string help;
+        Type type;
+        std::vector<std::unique_ptr<Series>> series;
+    };
+
+    // Caller holds _mutex. Returns the series, creating it (and the family) if needed.
+    Series& series(const std::string& name, const std::string& help, Type type, const std::string& labels);
+
+    mutable std::mutex _mutex;
+    std::vector<std::unique_ptr<Family>> _families;  // export order = registration order
+};
+
+// The app's own metrics, registered once so instrumented code only holds references.
+struct AppMetrics {
+    explicit AppMetrics(MetricsRegistry& registry);
+
+    MetricsRegistry& registry;
+    Counter& pose_callbacks;
+    Histogram& pose_persons;
+    Counter& reauth_success;
+    Counter& reauth_failure;
+    Histogram& authenticate_seconds;
+    Histogram& set_device_config_seconds;
+    Counter& render_frames;
+    Histogram& render_frame_seconds;  // interval between presented frames while active
+    Counter& connect_ok;
+    Counter& connect_failed;
+    Histogram& connect_seconds;
+};
+
+} // namespace simonsays
@@ -0,0 +1,182 @@
+// Simon Says: minimal HTTP endpoint for metrics (see metrics_http.h).
+
+#include "metrics_http.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using socket_len = int;
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+using socket_len = socklen_t;
+#endif
+
+namespace simonsays {
+
+namespace {
+
+#ifdef _WIN32
+constexpr intptr_t NO_SOCKET = static_cast<intptr_t>(INVALID_SOCKET);
+void close_socket(intptr_t s) { closesocket(static_cast<SOCKET>(s)); }
+int socket_error() { return WSAGetLastError(); }
+bool interrupted(int error) { return error == WSAEINTR; }
+#else
+constexpr intptr_t NO_SOCKET = -1;
+void close_socket(intptr_t s) { close(static_cast<int>(s)); }
+int socket_error() { return errno; }
+bool interrupted(int error) { return error == EINTR; }
+#endif
+
+// A scraper that disconnects mid-response must not raise SIGPIPE (which would end the app):
+// Linux takes a per-call flag, macOS a socket option (set in handle()).
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SEND_FLAGS = 0;
+#endif
+
+bool send_all(intptr_t s, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        int n = send(s, data.data() + sent, static_cast<int>(data.size() - sent), SEND_FLAGS);
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+MetricsHttpServer::~MetricsHttpServer() {
+    stop();
+}
+
+bool MetricsHttpServer::start(const std::string& address, uint16_t port) {
+    if (_thread.joinable()) return true;
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return false;
+#endif
+    auto fail = []() {
+#ifdef _WIN32
+        WSACleanup();  // pairs with the WSAStartup above
+#endif
+        return false;
+    };
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) return fail();
+
+    intptr_t s = static_cast<intptr_t>(socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+    if (s == NO_SOCKET) return fail();
+    int yes = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&yes), sizeof(yes));
+    if (bind(s, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || listen(s, 8) != 0) {
+        close_socket(s);
+        return fail();
+    }
+    _listen = s;
+    _stopping = false;
+    _thread = std::thread([this]() { serve(); });
+    return true;
+}
+
+void MetricsHttpServer::stop() {
+    if (!_thread.joinable()) return;
+    _stopping = true;
+    // Unblocks accept() on both platforms.
+#ifdef _WIN32
+    shutdown(static_cast<SOCKET>(_listen), SD_BOTH);
+#else
+    shutdown(static_cast<int>(_listen), SHUT_RDWR);
+#endif
+    close_socket(_listen);
+    _thread.join();
+    _listen = NO_SOCKET;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+void MetricsHttpServer::serve() {
+    // accept() errors other than EINTR (out of descriptors, say) usually persist: back off instead
+    // of spinning, and report the first one.
+    std::chrono::milliseconds backoff{0};
+    bool reported = false;
+    while (!_stopping.load()) {
+        intptr_t client = static_cast<intptr_t>(accept(_listen, nullptr, nullptr));
+        if (client == NO_SOCKET) {
+            const int error = socket_error();
+            if (_stopping.load()) break;
+            if (interrupted(error)) continue;
+            if (!reported) {
+                std::cerr << "Metrics endpoint: accept failed (error " << error << "); retrying with backoff."
+                          << std::endl;
+                reported = true;
+            }
+            backoff = std::min(std::max(backoff * 2, std::chrono::milliseconds(10)), std::chrono::milliseconds(500));
+            std::this_thread::sleep_for(backoff);
+            continue;
+        }
+        backoff = std::chrono::milliseconds(0);
+        handle(client);
+        close_socket(client);
+    }
+}
+
+void MetricsHttpServer::handle(intptr_t client) {
+    // A stuck client, reading or writing, must not hold up the next scrape (or shutdown) for long.
+#ifdef _WIN32
+    DWORD timeout_ms = 2000;
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout_ms), sizeof(timeout_ms));
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout_ms), sizeof(timeout_ms));
+#else
+    timeval timeout = {2, 0};
+    setsockopt(static_cast<int>(client), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(static_cast<int>(client), SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#ifdef SO_NOSIGPIPE
+    int no_sigpipe = 1;
+    setsockopt(static_cast<int>(client), SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+#endif
+    std::string request;
+    char buf[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        int n = recv(client, buf, sizeof(buf), 0);
+        if (n <= 0) return;
+        request.append(buf, static_cast<size_t>(n));
+    }
+
+    const bool is_get = request.compare(0, 4, "GET ") == 0;
+    const size_t path_end = request.find(' ', 4);
+    const std::string path = is_get && path_end != std::string::npos ? request.substr(4, path_end - 4) : "";
+    std::string status = "200 OK";
+    std::string body;
+    if (!is_get) {
+        status = "405 Method Not Allowed";
+    } else if (path == "/metrics" || path == "/") {
+        body = _registry.prometheus_text();
+        _scrapes.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        status = "404 Not Found";
+    }
+    send_all(client, "HTTP/1.1 " + status +
+                         "\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: " +
+                         std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body);
+}
+
+} // namespace simonsays
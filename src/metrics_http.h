@@ -0,0 +1,42 @@
+// Simon Says: minimal HTTP endpoint serving a MetricsRegistry for Prometheus to scrape.
+// One thread accepts connections and answers GET /metrics with the current text snapshot; other
+// paths get 404. Requests are handled one at a time, which is plenty for a scrape every few seconds.
+
+#pragma once
+
+#include "metrics.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace simonsays {
+
+class MetricsHttpServer {
+public:
+    explicit MetricsHttpServer(const MetricsRegistry& registry) : _registry(registry) {}
+    ~MetricsHttpServer();
+    MetricsHttpServer(const MetricsHttpServer&) = delete;
+    MetricsHttpServer& operator=(const MetricsHttpServer&) = delete;
+
+    // Binds address:port (e.g. "127.0.0.1", or "0.0.0.0" to allow remote scrapes) and starts
+    // serving. Returns false if the socket cannot be bound.
+    bool start(const std::string& address, uint16_t port);
+    // Closes the listening socket, which ends the accept loop, and joins the thread.
+    void stop();
+
+    uint64_t scrapes() const { return _scrapes.load(std::memory_order_relaxed); }
+
+private:
+    void serve();
+    void handle(intptr_t client);
+
+    const MetricsRegistry& _registry;
+    intptr_t _listen = -1;  // SOCKET on Windows, fd elsewhere
+    std::atomic<bool> _stopping{false};
+    std::thread _thread;
+    std::atomic<uint64_t> _scrapes{0};
+};
+
+} // namespace simonsays
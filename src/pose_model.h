@@ -0,0 +1,23 @@
+// Simon Says: pose model shared by rendering and kinematics (camera frame, COCO skeleton).
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+namespace simonsays {
+
+// Camera frame size used by RealSense ID for pose (FHD)
+constexpr double CAM_WIDTH = 1920.0;
+constexpr double CAM_HEIGHT = 1080.0;
+
+// COCO keypoints: 0=Nose, 1=LeftEye, 2=RightEye, 3=LeftEar, 4=RightEar,
+// 5=LeftShoulder, 6=RightShoulder, 7=LeftElbow, 8=RightElbow, 9=LeftWrist, 10=RightWrist,
+// 11=LeftHip, 12=RightHip, 13=LeftKnee, 14=RightKnee, 15=LeftAnkle, 16=RightAnkle
+inline constexpr std::pair<int, int> POSE_CONNECTIONS[] = {
+    {15, 13}, {13, 11}, {16, 14}, {14, 12}, {11, 12}, {5, 11}, {6, 12},
+    {5, 6},   {5, 7},   {7, 9},   {6, 8},   {8, 10},  {0, 1},  {0, 2}, {1, 3}, {2, 4}
+};
+constexpr size_t NUM_POSE_CONNECTIONS = sizeof(POSE_CONNECTIONS) / sizeof(POSE_CONNECTIONS[0]);
+
+} // namespace simonsays
@@ -0,0 +1,71 @@
+// Simon Says: pose handoff -> processing -> render path (see pose_pipeline.h).
+
+#include "pose_pipeline.h"
+#include "trace.h"
+
+namespace simonsays {
+
+PosePipeline::PosePipeline(PoseWatchdog& watchdog, size_t queue_capacity)
+    : _watchdog(watchdog), _pose_frames(queue_capacity), _render_frames(1) {}
+
+PosePipeline::~PosePipeline() {
+    close();
+    join();
+}
+
+void PosePipeline::start() {
+    if (_thread.joinable()) return;
+    _thread = std::thread([this]() { process(); });
+}
+
+void PosePipeline::close() {
+    _pose_frames.close();
+    if (!_thread.joinable()) _render_frames.close();  // never started: nothing will drain it
+}
+
+void PosePipeline::join() {
+    if (_thread.joinable()) _thread.join();
+}
+
+bool PosePipeline::handoff(const std::vector<RealSenseID::PersonPose>& poses, unsigned int device_ts,
+                           Clock::time_point arrival) {
+    SIMONSAYS_TRACE_SCOPE("pose handoff", "pose");
+    return _pose_frames.push(PoseFrame{poses, device_ts, arrival});
+}
+
+void PosePipeline::latest(std::vector<RealSenseID::PersonPose>& out) const {
+    std::lock_guard<std::mutex> lock(_latest_mutex);
+    out = _latest;
+}
+
+void PosePipeline::process() {
+    SIMONSAYS_TRACE_THREAD_NAME("pose processing");
+    PoseFrame frame;
+    while (_pose_frames.pop(frame)) {
+        SIMONSAYS_TRACE_SCOPE_ARG("process frame", "pose", "persons", frame.poses.size());
+        if (!_watchdog.admit(frame.device_ts, frame.arrival, Clock::now(), _pose_frames.size()))
+            continue;
+        if (_on_frame) _on_frame(frame);
+        {
+            std::lock_guard<std::mutex> lock(_latest_mutex);
+            _latest = frame.poses;
+        }
+        if (!_render_frames.push(std::move(frame))) _render_refused.fetch_add(1, std::memory_order_relaxed);
+    }
+    _render_frames.close();
+}
+
+void PoseStreamCallback::OnPoseDetected(const std::vector<RealSenseID::PersonPose>& poses, unsigned int ts) {
+    SIMONSAYS_TRACE_THREAD_NAME("device callback");
+    SIMONSAYS_TRACE_SCOPE_ARG("OnPoseDetected", "pose", "persons", poses.size());
+    auto now = Clock::now();
+    _watchdog.on_arrival(ts, now);
+    if (_presence) _presence->on_poses(poses.size(), now);
+    if (_metrics) {
+        _metrics->pose_callbacks.inc();
+        _metrics->pose_persons.observe(static_cast<double>(poses.size()));
+    }
+    if (_authenticated) _pipeline.handoff(poses, ts, now);
+}
+
+} // namespace simonsays
@@ -0,0 +1,102 @@
+// Simon Says: pose handoff -> processing -> render path.
+// The device callback hands frames to a processing thread, which drops stale frames (via the
+// watchdog), publishes the latest pose and forwards the newest frame to the render stage.
+
+#pragma once
+
+#include "RealSenseID/FaceAuthenticator.h"
+#include "metrics.h"
+#include "presence.h"
+#include "runtime.h"
+#include "watchdog.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace simonsays {
+
+// One OnPoseDetected callback, stamped with its arrival time on the host.
+struct PoseFrame {
+    std::vector<RealSenseID::PersonPose> poses;
+    unsigned int device_ts = 0;
+    Clock::time_point arrival;
+};
+
+class PosePipeline {
+public:
+    explicit PosePipeline(PoseWatchdog& watchdog, size_t queue_capacity = 8);
+    ~PosePipeline();
+    PosePipeline(const PosePipeline&) = delete;
+    PosePipeline& operator=(const PosePipeline&) = delete;
+
+    // Runs on the processing thread for every admitted frame, before it reaches the renderer.
+    // Set before start().
+    void set_frame_handler(std::function<void(const PoseFrame&)> handler) { _on_frame = std::move(handler); }
+
+    void start();
+    // Stops accepting frames. The processing thread finishes what is queued, then closes the
+    // render slot, so a renderer still waiting gets the last frame. Safe from any thread.
+    void close();
+    void join();
+
+    // Device callback thread. Returns false once closed.
+    bool handoff(const std::vector<RealSenseID::PersonPose>& poses, unsigned int device_ts, Clock::time_point arrival);
+
+    // Render stage: waits up to timeout for the newest processed frame.
+    template <typename Rep, typename Period>
+    bool next_frame(PoseFrame& out, std::chrono::duration<Rep, Period> timeout) {
+        return _render_frames.pop_for(out, timeout);
+    }
+
+    // Latest processed pose (thread-safe copy), for renderers that pull on their own timer.
+    void latest(std::vector<RealSenseID::PersonPose>& out) const;
+
+    uint64_t frames() const { return _pose_frames.pushed(); }
+    // Frames lost because processing fell behind (the watchdog counts those dropped as stale).
+    uint64_t dropped() const { return _pose_frames.dropped(); }
+    // Processed frames replaced in the render slot before a renderer took them. Not a loss: the
+    // slot only holds the newest pose, and renderers that pull latest() or sit idle never pop it.
+    uint64_t superseded() const {
+        return _render_frames.dropped() + _render_refused.load(std::memory_order_relaxed);
+    }
+
+private:
+    void process();
+
+    PoseWatchdog& _watchdog;
+    MessageQueue<PoseFrame> _pose_frames;
+    MessageQueue<PoseFrame> _render_frames;  // latest-value slot: the renderer only wants the newest frame
+    std::function<void(const PoseFrame&)> _on_frame;
+    std::atomic<uint64_t> _render_refused{0};  // processed after the render queue closed
+    std::thread _thread;
+    mutable std::mutex _latest_mutex;
+    std::vector<RealSenseID::PersonPose> _latest;
+};
+
+// AuthenticateLoop callback feeding the pipeline. Every frame reaches the watchdog as a sign of
+// life (and the presence monitor and metrics, if any); poses are only handed off while
+// authenticated, so the stick man freezes otherwise.
+class PoseStreamCallback : public RealSenseID::AuthenticationCallback {
+public:
+    PoseStreamCallback(PoseWatchdog& watchdog, PosePipeline& pipeline, const std::atomic<bool>& authenticated,
+                       PresenceMonitor* presence = nullptr, AppMetrics* metrics = nullptr)
+        : _watchdog(watchdog), _pipeline(pipeline), _authenticated(authenticated), _presence(presence),
+          _metrics(metrics) {}
+    void OnResult(RealSenseID::AuthenticateStatus, const char*, short) override {}
+    void OnHint(RealSenseID::AuthenticateStatus, float) override {}
+    void OnPoseDetected(const std::vector<RealSenseID::PersonPose>& poses, unsigned int ts) override;
+
+private:
+    PoseWatchdog& _watchdog;
+    PosePipeline& _pipeline;
+    const std::atomic<bool>& _authenticated;
+    PresenceMonitor* _presence;
+    AppMetrics* _metrics;
+};
+
+} // namespace simonsays
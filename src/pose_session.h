@@ -0,0 +1,276 @@
+// Simon Says: device side of a play session.
+// Every SDK call runs on one persistent SerialWorker: AuthenticateLoop streams poses, the
+// runtime's timer wheel periodically cancels it for a one-shot face re-auth, and a watchdog tick
+// restarts the loop if callbacks stop or it ends on its own. With a PresenceMonitor, going idle
+// stops the stream: nobody in view -> short pose probes every probe_period; failed re-auth ->
+// only a re-auth attempt every reauth_interval. With AppMetrics, re-auth results and the
+// Authenticate/SetDeviceConfig latencies are recorded. Templated on the authenticator so the benchmarks
+// can drive the same flow against a fake device.
+
+#pragma once
+
+#include "RealSenseID/FaceAuthenticator.h"
+#include "metrics.h"
+#include "presence.h"
+#include "runtime.h"
+#include "trace.h"
+#include "watchdog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace simonsays {
+
+// One-shot Authenticate result.
+class AuthResultCallback : public RealSenseID::AuthenticationCallback {
+public:
+    std::atomic<RealSenseID::AuthenticateStatus> result{RealSenseID::AuthenticateStatus::CameraStarted};
+    std::string authenticated_user_id;
+
+    void OnResult(RealSenseID::AuthenticateStatus status, const char* userId, short) override {
+        result = status;
+        if (userId) authenticated_user_id = userId;
+    }
+    void OnHint(RealSenseID::AuthenticateStatus, float) override {}
+};
+
+struct SessionConfig {
+    std::chrono::milliseconds reauth_interval{10000};
+    std::chrono::milliseconds watchdog_period{250};
+    // Restarts of a loop that keeps ending back off exponentially; the first frame resets them.
+    std::chrono::milliseconds restart_backoff_min{250};
+    std::chrono::milliseconds restart_backoff_max{8000};
+    std::chrono::milliseconds restart_log_interval{10000};  // at most one restart message per interval
+};
+
+struct SessionStats {
+    uint64_t device_jobs = 0;
+    uint64_t reauths = 0;
+    uint64_t failed_reauths = 0;
+    uint64_t probes = 0;  // duty-cycled pose probes while idle
+};
+
+// Device needs AuthenticateLoop, Authenticate, Cancel and SetDeviceConfig with the
+// FaceAuthenticator signatures. Shutdown order: runtime.request_quit(), stop(), then stop the
+// runtime before the session is destroyed (its timers reference it).
+template <typename Device>
+class PoseSession {
+public:
+    PoseSession(Device& device, Runtime& runtime, PoseWatchdog& watchdog, RealSenseID::AuthenticationCallback& pose_cb,
+                RealSenseID::DeviceConfig dev_config, std::atomic<bool>& authenticated, SessionConfig config = {},
+                PresenceMonitor* presence = nullptr, AppMetrics* metrics = nullptr)
+        : _device(device), _runtime(runtime), _watchdog(watchdog), _pose_cb(pose_cb), _dev_config(dev_config),
+          _authenticated(authenticated), _config(config), _presence(presence), _metrics(metrics) {
+        if (_presence)
+            _presence->add_listener([this](PowerState) { _runtime.post([this]() { sync_power_state(); }); });
+    }
+    PoseSession(const PoseSession&) = delete;
+    PoseSession& operator=(const PoseSession&) = delete;
+
+    // Starts streaming; the device must already be in PoseEstimationOnly.
+    void start() {
+        _worker.start();
+        _worker.post([this]() { pose_loop_job(); });
+        schedule_reauth();
+        _runtime.schedule_every(_config.watchdog_period, [this]() { watchdog_tick(); });
+    }
+
+    // Call after runtime.request_quit(): no new pose loop starts, and a Cancel that reached the
+    // device just before a job entered the SDK is repeated until the worker drains.
+    void stop() {
+        while (!_worker.idle()) {
+            cancel();
+            _worker.wait_idle_for(std::chrono::milliseconds(200));
+        }
+        _worker.stop();
+    }
+
+    // Ends a blocking AuthenticateLoop; safe from any thread.
+    void cancel() {
+        SIMONSAYS_TRACE_SCOPE("Cancel", "device");
+        _device.Cancel();
+    }
+
+    bool pose_loop_running() const { return _loop_running.load(); }
+
+    SessionStats stats() const {
+        SessionStats s;
+        s.device_jobs = _worker.jobs_run();
+        s.reauths = _reauths.load();
+        s.failed_reauths = _failed_reauths.load();
+        s.probes = _probes.load();
+        return s;
+    }
+
+private:
+    void pose_loop_job() {
+        SIMONSAYS_TRACE_THREAD_NAME("device worker");
+        // Publish before checking: a quit or re-auth racing with this job either sees
+        // _loop_running and cancels, or is seen here and the loop never starts.
+        _loop_running = true;
+        if (!_runtime.quit_requested() && !_reauth_pending) {
+            SIMONSAYS_TRACE_SCOPE("AuthenticateLoop", "device");
+            _device.AuthenticateLoop(_pose_cb);
+        }
+        _loop_running = false;
+    }
+
+    bool idle() const { return _presence && _presence->idle(); }
+
+    void reauth_job() {
+        _reauth_pending = false;
+        if (_runtime.quit_requested()) return;
+        SIMONSAYS_TRACE_THREAD_NAME("device worker");
+        SIMONSAYS_TRACE_SCOPE("reauth", "session");
+        _dev_config.algo_flow = RealSenseID::DeviceConfig::AlgoFlow::All;
+        set_device_config();
+        AuthResultCallback reauth_cb;
+        {
+            ScopedTimer timer(_metrics ? &_metrics->authenticate_seconds : nullptr);
+            SIMONSAYS_TRACE_SCOPE("Authenticate", "device");
+            _device.Authenticate(reauth_cb);
+        }
+        _authenticated = (reauth_cb.result == RealSenseID::AuthenticateStatus::Success);
+        ++_reauths;
+        if (!_authenticated) ++_failed_reauths;
+        if (_metrics) (_authenticated ? _metrics->reauth_success : _metrics->reauth_failure).inc();
+        if (_presence) _presence->on_reauth(_authenticated, Clock::now());
+        _dev_config.algo_flow = RealSenseID::DeviceConfig::AlgoFlow::PoseEstimationOnly;
+        set_device_config();
+        if (idle()) return;  // the probe timer retries re-auth
+        _worker.post([this]() { pose_loop_job(); });
+        schedule_reauth();
+    }
+
+    void set_device_config() {
+        ScopedTimer timer(_metrics ? &_metrics->set_device_config_seconds : nullptr);
+        SIMONSAYS_TRACE_SCOPE("SetDeviceConfig", "device");
+        _device.SetDeviceConfig(_dev_config);
+    }
+
+    // Only the most recently scheduled re-auth fires; going idle or waking up supersedes it.
+    void schedule_reauth() {
+        uint64_t gen = ++_reauth_gen;
+        _runtime.schedule_after(_config.reauth_interval, [this, gen]() {
+            if (gen == _reauth_gen.load()) trigger_reauth();
+        });
+    }
+
+    // Cancels only a running pose loop: a Cancel landing in another job (a probe's re-auth, say)
+    // would abort it instead. The watchdog tick repeats the Cancel if this one was lost.
+    void trigger_reauth() {
+        _reauth_pending = true;
+        if (!_worker.post([this]() { reauth_job(); })) {
+            _reauth_pending = false;  // worker backed up; the next interval tries again
+            schedule_reauth();
+            return;
+        }
+        if (_loop_running) cancel();
+    }
+
+    // Executor: applies a PresenceMonitor state change to the device.
+    void sync_power_state() {
+        const bool idle_now = idle();
+        if (idle_now == _idle || _runtime.quit_requested()) return;
+        _idle = idle_now;
+        if (_idle) {
+            SIMONSAYS_TRACE_INSTANT("go idle", "session");
+            ++_reauth_gen;
+            if (_loop_running) cancel();  // stop streaming; probes take over
+            auto period = _presence->reason() == IdleReason::AuthFailed ? _config.reauth_interval
+                                                                         : _presence->config().probe_period;
+            _probe_timer = _runtime.schedule_every(period, [this]() { probe(); });
+        } else {
+            SIMONSAYS_TRACE_INSTANT("wake", "session");
+            _runtime.cancel_timer(_probe_timer);
+            // The probe loop that saw the player keeps streaming; re-auth resumes its cadence.
+            if (!_loop_running && _worker.idle()) _worker.post([this]() { pose_loop_job(); });
+            schedule_reauth();
+        }
+    }
+
+    void probe() {
+        if (!idle() || _runtime.quit_requested()) return;
+        if (!_worker.idle()) {
+            if (_loop_running) cancel();  // a probe outlived its window
+            return;
+        }
+        ++_probes;
+        if (_presence->reason() == IdleReason::AuthFailed) {
+            _worker.post([this]() { reauth_job(); });
+            return;
+        }
+        _worker.post([this]() { pose_loop_job(); });
+        _runtime.schedule_after(_presence->config().probe_window, [this]() {
+            if (idle()) cancel();
+        });
+    }
+
+    void watchdog_tick() {
+        auto now = Clock::now();
+        if (_presence) _presence->check(now);
+        const bool idle_now = idle();
+        if (_watchdog.check(now, _loop_running && !idle_now)) {
+            std::cerr << "Watchdog: no pose frames for " << _watchdog.config().stall_timeout.count()
+                      << " ms; restarting pose loop." << std::endl;
+            SIMONSAYS_TRACE_INSTANT("watchdog stall", "session");
+            cancel();
+        }
+        // The SDK ignores a Cancel that arrives before AuthenticateLoop is underway.
+        if (_reauth_pending && _loop_running) cancel();
+        const uint64_t frames = _watchdog.stats(now).frames;
+        if (frames != _frames_at_restart) {  // the restarted loop delivered: back to full speed
+            _frames_at_restart = frames;
+            _restart_backoff = _config.restart_backoff_min;
+            _next_restart = {};
+        }
+        if (!idle_now && !_loop_running && _worker.idle() && !_runtime.quit_requested() && now >= _next_restart)
+            restart_pose_loop(now);
+    }
+
+    void restart_pose_loop(Clock::time_point now) {
+        _watchdog.note_restart(now);
+        _worker.post([this]() { pose_loop_job(); });
+        _next_restart = now + _restart_backoff;
+        ++_restarts_unlogged;
+        if (now - _last_restart_log >= _config.restart_log_interval) {
+            std::cerr << "Watchdog: pose loop ended; restarting AuthenticateLoop";
+            if (_restarts_unlogged > 1) std::cerr << " (" << _restarts_unlogged << " restarts since the last message)";
+            std::cerr << ", next retry no sooner than " << _restart_backoff.count() << " ms." << std::endl;
+            _last_restart_log = now;
+            _restarts_unlogged = 0;
+        }
+        _restart_backoff = std::min(_restart_backoff * 2, _config.restart_backoff_max);
+    }
+
+    Device& _device;
+    Runtime& _runtime;
+    PoseWatchdog& _watchdog;
+    RealSenseID::AuthenticationCallback& _pose_cb;
+    RealSenseID::DeviceConfig _dev_config;  // only touched on the worker
+    std::atomic<bool>& _authenticated;
+    const SessionConfig _config;
+    PresenceMonitor* _presence;
+    AppMetrics* _metrics;
+    SerialWorker _worker;
+    std::atomic<bool> _loop_running{false};
+    std::atomic<bool> _reauth_pending{false};  // re-auth queued behind the pose loop
+    std::atomic<uint64_t> _reauths{0};
+    std::atomic<uint64_t> _failed_reauths{0};
+    std::atomic<uint64_t> _probes{0};
+    std::atomic<uint64_t> _reauth_gen{0};
+    bool _idle = false;                 // executor only
+    TimerWheel::Id _probe_timer = 0;    // executor only
+    // Watchdog restarts; executor only.
+    std::chrono::milliseconds _restart_backoff{_config.restart_backoff_min};
+    Clock::time_point _next_restart;
+    uint64_t _frames_at_restart = 0;
+    Clock::time_point _last_restart_log;
+    uint64_t _restarts_unlogged = 0;
+};
+
+} // namespace simonsays
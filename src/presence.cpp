@@ -0,0 +1,148 @@
+// Simon Says: presence-driven power states (see presence.h).
+
+#include "presence.h"
+
+#include <algorithm>
+
+namespace simonsays {
+
+namespace {
+
+double to_sec(Clock::duration d) {
+    return std::chrono::duration<double>(d).count();
+}
+
+} // namespace
+
+PresenceMonitor::PresenceMonitor(PresenceConfig config)
+    : _config(config), _last_person(Clock::now()), _state_since(_last_person), _state_cpu_start(process_cpu_seconds()) {}
+
+void PresenceMonitor::add_listener(Listener listener) {
+    _listeners.push_back(std::move(listener));
+}
+
+void PresenceMonitor::on_poses(size_t people, Clock::time_point now) {
+    if (people == 0) return;
+    bool woke = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _last_person = now;
+        // An unrecognized player keeps us idle; only a successful re-auth ends AuthFailed.
+        if (_state == PowerState::Idle && _reason == IdleReason::NoPlayer) {
+            woke = set_state(PowerState::Active, IdleReason::None, now);
+            _wake_seen = now;
+            _wake_pending = true;
+        }
+    }
+    if (woke) notify(PowerState::Active);
+}
+
+void PresenceMonitor::on_reauth(bool success, Clock::time_point now) {
+    bool changed = false;
+    PowerState to = PowerState::Active;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (success) {
+            _last_person = now;
+            if (_state == PowerState::Idle) {
+                changed = set_state(PowerState::Active, IdleReason::None, now);
+                _wake_seen = now;
+                _wake_pending = true;
+            }
+        } else if (_config.idle_on_failed_reauth && _state == PowerState::Active) {
+            to = PowerState::Idle;
+            changed = set_state(PowerState::Idle, IdleReason::AuthFailed, now);
+        }
+    }
+    if (changed) notify(to);
+}
+
+void PresenceMonitor::check(Clock::time_point now) {
+    if (_config.idle_after.count() <= 0) return;
+    bool changed = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_state == PowerState::Active && now - _last_person >= _config.idle_after)
+            changed = set_state(PowerState::Idle, IdleReason::NoPlayer, now);
+    }
+    if (changed) notify(PowerState::Idle);
+}
+
+void PresenceMonitor::note_rendered(Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_wake_pending || _state != PowerState::Active) return;
+    _wake_pending = false;
+    _stats.last_wake_ms = std::chrono::duration<double, std::milli>(now - _wake_seen).count();
+    _stats.max_wake_ms = std::max(_stats.max_wake_ms, _stats.last_wake_ms);
+}
+
+bool PresenceMonitor::wait_active(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait_for(lock, timeout, [this]() { return _state == PowerState::Active || _closed; });
+    return _state == PowerState::Active && !_closed;
+}
+
+void PresenceMonitor::close() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _closed = true;
+    }
+    _cv.notify_all();
+}
+
+PowerState PresenceMonitor::state() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _state;
+}
+
+IdleReason PresenceMonitor::reason() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _reason;
+}
+
+PresenceStats PresenceMonitor::stats(Clock::time_point now) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    PresenceStats s = _stats;
+    // Include the period we are in.
+    double sec = to_sec(now - _state_since);
+    double cpu = process_cpu_seconds() - _state_cpu_start;
+    double idle_cpu = _idle_cpu, active_cpu = _active_cpu;
+    if (_state == PowerState::Idle) {
+        s.idle_seconds += sec;
+        idle_cpu += cpu;
+    } else {
+        s.active_seconds += sec;
+        active_cpu += cpu;
+    }
+    s.idle_cpu_percent = s.idle_seconds > 0 ? 100.0 * idle_cpu / s.idle_seconds : 0;
+    s.active_cpu_percent = s.active_seconds > 0 ? 100.0 * active_cpu / s.active_seconds : 0;
+    return s;
+}
+
+bool PresenceMonitor::set_state(PowerState state, IdleReason reason, Clock::time_point now) {
+    if (state == _state) return false;
+    double sec = to_sec(now - _state_since);
+    double cpu_now = process_cpu_seconds();
+    if (_state == PowerState::Idle) {
+        _stats.idle_seconds += sec;
+        _idle_cpu += cpu_now - _state_cpu_start;
+        ++_stats.wakes;
+    } else {
+        _stats.active_seconds += sec;
+        _active_cpu += cpu_now - _state_cpu_start;
+        ++_stats.idle_periods;
+    }
+    _state = state;
+    _reason = reason;
+    _state_since = now;
+    _state_cpu_start = cpu_now;
+    if (state == PowerState::Active) _last_person = now;
+    _cv.notify_all();
+    return true;
+}
+
+void PresenceMonitor::notify(PowerState state) {
+    for (const auto& listener : _listeners) listener(state);
+}
+
+} // namespace simonsays
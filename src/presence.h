@@ -0,0 +1,98 @@
+// Simon Says: presence-driven power states.
+// Goes idle when the pose stream has shown nobody for a while, or when re-auth fails, and wakes
+// as soon as a person shows up (or a later re-auth succeeds). While idle the renderer stops
+// redrawing and PoseSession only runs short, duty-cycled pose probes. Tracks process CPU use in
+// each state and the wake-up latency so the saving can be checked.
+
+#pragma once
+
+#include "runtime.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace simonsays {
+
+enum class PowerState { Active, Idle };
+
+enum class IdleReason {
+    None,
+    NoPlayer,    // empty pose list for idle_after
+    AuthFailed,  // re-auth did not recognize the player
+};
+
+struct PresenceConfig {
+    std::chrono::milliseconds idle_after{30000};  // 0 disables going idle on an empty scene
+    bool idle_on_failed_reauth = true;
+    // While idle with nobody in view, a pose probe runs for probe_window every probe_period, so a
+    // person is noticed within about probe_period + device start-up.
+    std::chrono::milliseconds probe_period{1500};
+    std::chrono::milliseconds probe_window{500};
+};
+
+struct PresenceStats {
+    uint64_t idle_periods = 0;
+    uint64_t wakes = 0;
+    double idle_seconds = 0;
+    double active_seconds = 0;
+    double idle_cpu_percent = 0;    // process CPU while idle, % of one core
+    double active_cpu_percent = 0;
+    double last_wake_ms = 0;        // person seen -> first frame rendered
+    double max_wake_ms = 0;
+};
+
+class PresenceMonitor {
+public:
+    using Listener = std::function<void(PowerState)>;
+
+    explicit PresenceMonitor(PresenceConfig config = {});
+
+    // Register before the session starts. Called on the thread that caused the change; keep it short.
+    void add_listener(Listener listener);
+
+    // Device callback thread, every pose frame (authenticated or not).
+    void on_poses(size_t people, Clock::time_point now);
+    // Device worker, after each re-auth.
+    void on_reauth(bool success, Clock::time_point now);
+    // Executor tick; goes idle once nobody has been seen for idle_after.
+    void check(Clock::time_point now);
+    // Renderer, after presenting a frame; closes a pending wake-up measurement.
+    void note_rendered(Clock::time_point now);
+
+    // Renderer: blocks while idle. Returns true when active, false on timeout or close().
+    bool wait_active(std::chrono::milliseconds timeout);
+    void close();
+
+    PowerState state() const;
+    IdleReason reason() const;
+    bool idle() const { return state() == PowerState::Idle; }
+    const PresenceConfig& config() const { return _config; }
+    PresenceStats stats(Clock::time_point now) const;
+
+private:
+    // Caller holds _mutex; returns true if the state changed.
+    bool set_state(PowerState state, IdleReason reason, Clock::time_point now);
+    void notify(PowerState state);
+
+    const PresenceConfig _config;
+    std::vector<Listener> _listeners;
+    mutable std::mutex _mutex;
+    std::condition_variable _cv;
+    PowerState _state = PowerState::Active;
+    IdleReason _reason = IdleReason::None;
+    bool _closed = false;
+    Clock::time_point _last_person;
+    Clock::time_point _state_since;
+    double _state_cpu_start = 0;
+    double _idle_cpu = 0, _active_cpu = 0;  // process CPU seconds in finished periods
+    Clock::time_point _wake_seen;  // person frame that woke us; cleared once rendered
+    bool _wake_pending = false;
+    PresenceStats _stats;
+};
+
+} // namespace simonsays
@@ -0,0 +1,311 @@
+// Simon Says: event-driven runtime (see runtime.h).
+
+#include "runtime.h"
+#include "trace.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace simonsays {
+
+double process_cpu_seconds() {
+#ifdef _WIN32
+    FILETIME create, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &create, &exit, &kernel, &user)) return 0;
+    auto to_100ns = [](const FILETIME& f) { return (static_cast<uint64_t>(f.dwHighDateTime) << 32) | f.dwLowDateTime; };
+    return (to_100ns(kernel) + to_100ns(user)) * 1e-7;
+#else
+    rusage ru = {};
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec * 1e-6 + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec * 1e-6;
+#endif
+}
+
+// ---- WakeEvent ----
+#ifdef _WIN32
+WakeEvent::WakeEvent() {
+    _event = CreateEventW(nullptr, FALSE, FALSE, nullptr);  // auto-reset
+}
+
+WakeEvent::~WakeEvent() {
+    if (_event) CloseHandle(static_cast<HANDLE>(_event));
+}
+
+void WakeEvent::notify() {
+    SetEvent(static_cast<HANDLE>(_event));
+}
+
+bool WakeEvent::wait_for(std::chrono::milliseconds timeout) {
+    DWORD ms = timeout.count() < 0 ? INFINITE : static_cast<DWORD>(timeout.count());
+    DWORD rc = WaitForSingleObject(static_cast<HANDLE>(_event), ms);
+    _wakeups.fetch_add(1, std::memory_order_relaxed);
+    return rc == WAIT_OBJECT_0;
+}
+#else
+WakeEvent::WakeEvent() {
+    if (pipe(_fds) == 0) {
+        for (int fd : _fds) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+}
+
+WakeEvent::~WakeEvent() {
+    for (int fd : _fds)
+        if (fd >= 0) close(fd);
+}
+
+void WakeEvent::notify() {
+    const char b = 1;
+    ssize_t rc = write(_fds[1], &b, 1);  // EAGAIN means a wakeup is already pending
+    (void)rc;
+}
+
+bool WakeEvent::wait_for(std::chrono::milliseconds timeout) {
+    pollfd pfd = {_fds[0], POLLIN, 0};
+    int ms = timeout.count() < 0 ? -1 : static_cast<int>(std::min<int64_t>(timeout.count(), INT32_MAX));
+    int rc = poll(&pfd, 1, ms);
+    _wakeups.fetch_add(1, std::memory_order_relaxed);
+    if (rc <= 0) return false;
+    char buf[64];
+    while (read(_fds[0], buf, sizeof(buf)) > 0) {
+    }
+    return true;
+}
+#endif
+
+// ---- TimerWheel ----
+TimerWheel::TimerWheel(Clock::duration tick, size_t slots, Clock::time_point start)
+    : _tick(tick), _slots(slots ? slots : 1), _current(start) {}
+
+TimerWheel::Id TimerWheel::schedule(Clock::time_point due, Clock::duration period, Task task) {
+    Id id = _next_id++;
+    insert(Entry{id, due, period, std::move(task)});
+    return id;
+}
+
+void TimerWheel::insert(Entry entry) {
+    int64_t ticks = entry.due > _current ? (entry.due - _current) / _tick : 0;
+    size_t slot = (_cursor + static_cast<size_t>(ticks % static_cast<int64_t>(_slots.size()))) % _slots.size();
+    _slots[slot].push_back(std::move(entry));
+    ++_count;
+}
+
+bool TimerWheel::cancel(Id id) {
+    for (auto& slot : _slots) {
+        auto it = std::find_if(slot.begin(), slot.end(), [&](const Entry& e) { return e.id == id; });
+        if (it != slot.end()) {
+            slot.erase(it);
+            --_count;
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t TimerWheel::advance(Clock::time_point now, std::vector<Task>& out) {
+    if (now < _current) return 0;
+    int64_t ticks = (now - _current) / _tick;
+    if (_count == 0) {
+        _current += ticks * _tick;
+        _cursor = (_cursor + static_cast<size_t>(ticks % static_cast<int64_t>(_slots.size()))) % _slots.size();
+        return 0;
+    }
+
+    // Visit at most one full revolution; entries further out stay in their slot until due.
+    size_t steps = static_cast<size_t>(std::min<int64_t>(ticks, static_cast<int64_t>(_slots.size()) - 1));
+    size_t fired = 0;
+    std::vector<Entry> rearm;
+    for (size_t s = 0; s <= steps; ++s) {
+        auto& slot = _slots[(_cursor + s) % _slots.size()];
+        for (size_t i = 0; i < slot.size();) {
+            if (slot[i].due > now) {
+                ++i;
+                continue;
+            }
+            Entry e = std::move(slot[i]);
+            slot[i] = std::move(slot.back());
+            slot.pop_back();
+            --_count;
+            ++fired;
+            if (e.period > Clock::duration::zero()) {
+                out.push_back(e.task);
+                e.due += e.period;
+                if (e.due <= now) e.due = now + e.period;  // skip missed periods instead of bursting
+                rearm.push_back(std::move(e));
+            } else {
+                out.push_back(std::move(e.task));
+            }
+        }
+    }
+    _current += ticks * _tick;
+    _cursor = (_cursor + static_cast<size_t>(ticks % static_cast<int64_t>(_slots.size()))) % _slots.size();
+    for (auto& e : rearm) insert(std::move(e));
+    return fired;
+}
+
+Clock::time_point TimerWheel::next_deadline() const {
+    Clock::time_point next = Clock::time_point::max();
+    for (const auto& slot : _slots)
+        for (const auto& e : slot) next = std::min(next, e.due);
+    return next;
+}
+
+// ---- SerialWorker ----
+SerialWorker::SerialWorker(size_t capacity) : _jobs(capacity) {}
+
+SerialWorker::~SerialWorker() {
+    stop();
+}
+
+void SerialWorker::start() {
+    if (_thread.joinable()) return;
+    _thread = std::thread([this]() {
+        Task job;
+        while (_jobs.pop(job)) {
+            if (_jobs.closed()) break;  // drop queued jobs on shutdown
+            job();
+            _jobs_run.fetch_add(1, std::memory_order_relaxed);
+            finish_job();
+        }
+    });
+}
+
+bool SerialWorker::post(Task job) {
+    ++_outstanding;
+    if (_jobs.try_push(std::move(job))) return true;
+    finish_job();
+    return false;
+}
+
+void SerialWorker::finish_job() {
+    if (--_outstanding != 0) return;
+    // Lock so a waiter between its idle() check and the wait cannot miss this.
+    std::lock_guard<std::mutex> lock(_idle_mutex);
+    _idle_cv.notify_all();
+}
+
+void SerialWorker::stop() {
+    _jobs.close();
+    if (_thread.joinable()) _thread.join();
+}
+
+// ---- Runtime ----
+Runtime::Runtime(Clock::duration tick, size_t slots) : _timers(tick, slots, Clock::now()) {}
+
+Runtime::~Runtime() {
+    stop();
+}
+
+void Runtime::start() {
+    if (_executor.joinable()) return;
+    _executor = std::thread([this]() { run(); });
+}
+
+void Runtime::stop() {
+    request_quit();
+    if (!_executor.joinable()) return;
+    _executor.join();
+    int64_t requested = _quit_requested_at.load();
+    auto elapsed = Clock::now().time_since_epoch().count() - requested;
+    _shutdown_latency = std::chrono::duration_cast<std::chrono::microseconds>(Clock::duration(elapsed));
+}
+
+void Runtime::request_quit() {
+    int64_t expected = 0;
+    _quit_requested_at.compare_exchange_strong(expected, Clock::now().time_since_epoch().count());
+    _quit = true;
+    _wake.notify();
+}
+
+void Runtime::on_quit(Task hook) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _quit_hooks.push_back(std::move(hook));
+}
+
+void Runtime::post(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tasks.push_back(std::move(task));
+    }
+    _wake.notify();
+}
+
+TimerWheel::Id Runtime::schedule_after(Clock::duration delay, Task task) {
+    TimerWheel::Id id;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        id = _timers.schedule(Clock::now() + delay, Clock::duration::zero(), std::move(task));
+    }
+    _wake.notify();  // executor may need an earlier deadline
+    return id;
+}
+
+TimerWheel::Id Runtime::schedule_every(Clock::duration period, Task task) {
+    TimerWheel::Id id;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        id = _timers.schedule(Clock::now() + period, period, std::move(task));
+    }
+    _wake.notify();
+    return id;
+}
+
+void Runtime::cancel_timer(TimerWheel::Id id) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _timers.cancel(id);
+}
+
+RuntimeStats Runtime::stats() const {
+    RuntimeStats s;
+    s.wakeups = _wake.wakeups();
+    s.tasks_run = _tasks_run.load();
+    s.timers_fired = _timers_fired.load();
+    s.shutdown_latency = _shutdown_latency;
+    return s;
+}
+
+void Runtime::run() {
+    SIMONSAYS_TRACE_THREAD_NAME("executor");
+    for (;;) {
+        bool quitting = _quit.load();
+        std::vector<Task> ready;
+        size_t posted = 0;
+        Clock::time_point deadline;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            posted = _tasks.size();
+            for (auto& t : _tasks) ready.push_back(std::move(t));
+            _tasks.clear();
+            _timers_fired += _timers.advance(Clock::now(), ready);
+            if (quitting && !_hooks_ran) {
+                for (auto& h : _quit_hooks) ready.push_back(std::move(h));
+                _quit_hooks.clear();
+                _hooks_ran = true;
+            }
+            deadline = _timers.next_deadline();
+        }
+        for (auto& t : ready) t();
+        _tasks_run += posted;
+        if (quitting) break;
+
+        std::chrono::milliseconds timeout(-1);
+        if (deadline != Clock::time_point::max()) {
+            auto remaining = deadline - Clock::now();
+            timeout = std::max(std::chrono::milliseconds(0),
+                               std::chrono::ceil<std::chrono::milliseconds>(remaining));
+        }
+        _wake.wait_for(timeout);
+    }
+}
+
+} // namespace simonsays
@@ -0,0 +1,269 @@
+// Simon Says: small event-driven runtime shared by the device, processing and render stages.
+// One executor thread owns a timer wheel and a task queue; it sleeps on a WakeEvent until the
+// next deadline instead of polling, so quit/cancel wake it immediately.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace simonsays {
+
+using Clock = std::chrono::steady_clock;
+using Task = std::function<void()>;
+
+// Level-triggered wakeup. notify() is async-signal-safe (pipe write on POSIX, SetEvent on Windows)
+// so the Ctrl+C handler can use it directly.
+class WakeEvent {
+public:
+    WakeEvent();
+    ~WakeEvent();
+    WakeEvent(const WakeEvent&) = delete;
+    WakeEvent& operator=(const WakeEvent&) = delete;
+
+    void notify();
+    // Returns true if woken by notify(), false on timeout. A negative timeout waits forever.
+    bool wait_for(std::chrono::milliseconds timeout);
+    uint64_t wakeups() const { return _wakeups.load(std::memory_order_relaxed); }
+
+private:
+#ifdef _WIN32
+    void* _event = nullptr;
+#else
+    int _fds[2] = {-1, -1};
+#endif
+    std::atomic<uint64_t> _wakeups{0};
+};
+
+// Bounded multi-producer queue between pipeline stages. When full, the oldest message is dropped
+// (a stale pose is worth less than a fresh one). close() wakes every waiter.
+template <typename T>
+class MessageQueue {
+public:
+    explicit MessageQueue(size_t capacity) : _capacity(capacity ? capacity : 1) {}
+
+    // Returns false if the queue is closed.
+    bool push(T msg) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_closed) return false;
+            if (_items.size() >= _capacity) {
+                _items.pop_front();
+                ++_dropped;
+            }
+            _items.push_back(std::move(msg));
+            ++_pushed;
+        }
+        _cv.notify_one();
+        return true;
+    }
+
+    // Like push() but refuses the message instead of dropping the oldest when full, for queues
+    // where every message must run (device jobs).
+    bool try_push(T msg) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_closed || _items.size() >= _capacity) return false;
+            _items.push_back(std::move(msg));
+            ++_pushed;
+        }
+        _cv.notify_one();
+        return true;
+    }
+
+    // Blocks until a message arrives; returns false once closed and drained.
+    bool pop(T& out) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [&] { return _closed || !_items.empty(); });
+        return take(out);
+    }
+
+    // Like pop() but gives up after timeout; returns false on timeout or close.
+    template <typename Rep, typename Period>
+    bool pop_for(T& out, std::chrono::duration<Rep, Period> timeout) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait_for(lock, timeout, [&] { return _closed || !_items.empty(); });
+        return take(out);
+    }
+
+    bool try_pop(T& out) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return take(out);
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _closed = true;
+        }
+        _cv.notify_all();
+    }
+
+    bool closed() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _closed;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _items.size();
+    }
+
+    uint64_t pushed() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _pushed;
+    }
+
+    uint64_t dropped() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _dropped;
+    }
+
+private:
+    bool take(T& out) {
+        if (_items.empty()) return false;
+        out = std::move(_items.front());
+        _items.pop_front();
+        return true;
+    }
+
+    const size_t _capacity;
+    mutable std::mutex _mutex;
+    std::condition_variable _cv;
+    std::deque<T> _items;
+    bool _closed = false;
+    uint64_t _pushed = 0;
+    uint64_t _dropped = 0;
+};
+
+// Hashed timer wheel. Not thread-safe; Runtime serializes access.
+class TimerWheel {
+public:
+    using Id = uint64_t;
+
+    TimerWheel(Clock::duration tick, size_t slots, Clock::time_point start);
+
+    Id schedule(Clock::time_point due, Clock::duration period, Task task);
+    bool cancel(Id id);
+    // Moves expired tasks into out (periodic timers are re-armed) and returns how many fired.
+    size_t advance(Clock::time_point now, std::vector<Task>& out);
+    // Earliest pending deadline, or Clock::time_point::max() when the wheel is empty.
+    Clock::time_point next_deadline() const;
+    size_t size() const { return _count; }
+
+private:
+    struct Entry {
+        Id id;
+        Clock::time_point due;
+        Clock::duration period;
+        Task task;
+    };
+
+    void insert(Entry entry);
+
+    const Clock::duration _tick;
+    std::vector<std::vector<Entry>> _slots;
+    Clock::time_point _current;  // start of the tick that _cursor points at
+    size_t _cursor = 0;
+    size_t _count = 0;
+    Id _next_id = 1;
+};
+
+// Persistent worker thread that runs jobs one at a time, in order. Used for device I/O so the
+// SDK is only ever driven from a single thread and no thread is created per cycle.
+class SerialWorker {
+public:
+    explicit SerialWorker(size_t capacity = 16);
+    ~SerialWorker();
+
+    void start();
+    // Returns false (and the job never runs) when the queue is full or stopped; jobs are never
+    // dropped once accepted.
+    bool post(Task job);
+    // Stops accepting jobs, lets the current one finish (callers must cancel blocking SDK calls)
+    // and joins the thread.
+    void stop();
+    // True when no job is running or queued.
+    bool idle() const { return _outstanding.load() == 0; }
+    // Waits up to timeout for idle(); returns idle().
+    template <typename Rep, typename Period>
+    bool wait_idle_for(std::chrono::duration<Rep, Period> timeout) {
+        std::unique_lock<std::mutex> lock(_idle_mutex);
+        return _idle_cv.wait_for(lock, timeout, [this] { return idle(); });
+    }
+    uint64_t jobs_run() const { return _jobs_run.load(std::memory_order_relaxed); }
+
+private:
+    void finish_job();
+
+    MessageQueue<Task> _jobs;
+    std::thread _thread;
+    std::atomic<int> _outstanding{0};
+    std::mutex _idle_mutex;
+    std::condition_variable _idle_cv;
+    std::atomic<uint64_t> _jobs_run{0};
+};
+
+// Process CPU time (user + system, all threads) in seconds.
+double process_cpu_seconds();
+
+struct RuntimeStats {
+    uint64_t wakeups = 0;
+    uint64_t tasks_run = 0;
+    uint64_t timers_fired = 0;
+    std::chrono::microseconds shutdown_latency{0};  // request_quit() -> stop() fully joined
+};
+
+class Runtime {
+public:
+    explicit Runtime(Clock::duration tick = std::chrono::milliseconds(10), size_t slots = 256);
+    ~Runtime();
+    Runtime(const Runtime&) = delete;
+    Runtime& operator=(const Runtime&) = delete;
+
+    void start();
+    // Requests quit, runs the on_quit hooks on the executor and joins it.
+    void stop();
+
+    // Safe from signal handlers and any thread.
+    void request_quit();
+    bool quit_requested() const { return _quit.load(); }
+
+    // Hooks run once on the executor when quit is requested (close queues, cancel SDK calls).
+    void on_quit(Task hook);
+
+    void post(Task task);
+    TimerWheel::Id schedule_after(Clock::duration delay, Task task);
+    TimerWheel::Id schedule_every(Clock::duration period, Task task);
+    void cancel_timer(TimerWheel::Id id);
+
+    RuntimeStats stats() const;
+
+private:
+    void run();
+
+    WakeEvent _wake;
+    std::atomic<bool> _quit{false};
+    std::atomic<int64_t> _quit_requested_at{0};  // Clock ticks since epoch; 0 = not yet
+    std::thread _executor;
+
+    mutable std::mutex _mutex;
+    TimerWheel _timers;
+    std::deque<Task> _tasks;
+    std::vector<Task> _quit_hooks;
+    bool _hooks_ran = false;
+
+    std::atomic<uint64_t> _tasks_run{0};
+    std::atomic<uint64_t> _timers_fired{0};
+    std::chrono::microseconds _shutdown_latency{0};
+};
+
+} // namespace simonsays
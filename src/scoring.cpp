@@ -0,0 +1,103 @@
+// Simon Says: dance scoring (see scoring.h).
+
+#include "scoring.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace simonsays {
+
+namespace {
+
+// Segment pairs (limb indices into POSE_CONNECTIONS) that are straight when both point the same
+// way: ankle->knee + knee->hip for each leg, shoulder->elbow + elbow->wrist for each arm.
+constexpr int EXTENSION_CHAINS[][2] = {{0, 1}, {2, 3}, {8, 9}, {10, 11}};
+
+float ema(float prev, float sample, float alpha) {
+    return prev + alpha * (sample - prev);
+}
+
+} // namespace
+
+double BeatClock::distance(double t_sec) const {
+    double b = beats(t_sec);
+    return std::fabs(b - std::floor(b + 0.5));
+}
+
+ScoringEngine::ScoringEngine(ScoringConfig config, size_t max_people)
+    : _config(config), _clock(config.bpm), _scores(max_people ? max_people : 1),
+      _motion(_scores.size()), _motion_prev(_scores.size()), _motion_prev2(_scores.size()),
+      _speed(_scores.size()), _seen(_scores.size()), _ext(_scores.size()), _ext_n(_scores.size()) {}
+
+void ScoringEngine::reset() {
+    std::fill(_scores.begin(), _scores.end(), DanceScore{});
+    for (auto* v : {&_motion, &_motion_prev, &_motion_prev2})
+        std::fill(v->begin(), v->end(), 0.0f);
+    _people = 0;
+    _t_prev = 0;  // the next accent is timed against the new session, not the old one
+}
+
+void ScoringEngine::update(const KinematicsBatch& k, double t_sec) {
+    const size_t n = std::min(k.people(), _scores.size());
+    for (size_t p = n; p < _people; p++) {
+        _scores[p] = DanceScore{};
+        _motion_prev[p] = _motion_prev2[p] = 0.0f;
+    }
+    _people = n;
+
+    // Per-person means over limbs, accumulated limb by limb so each pass is a flat loop.
+    std::fill(_motion.begin(), _motion.begin() + n, 0.0f);
+    std::fill(_speed.begin(), _speed.begin() + n, 0.0f);
+    std::fill(_ext.begin(), _ext.begin() + n, 0.0f);
+    std::fill(_ext_n.begin(), _ext_n.begin() + n, 0.0f);
+    std::fill(_seen.begin(), _seen.begin() + n, 0.0f);
+    for (int l = 0; l < NUM_LIMBS; l++) {
+        const float* w = k.angular_velocity(l);
+        const float* s = k.limb_speed(l);
+        const float* v = k.valid(l);
+        for (size_t p = 0; p < n; p++) {
+            _motion[p] += std::fabs(w[p]) * v[p];
+            _speed[p] += s[p] * v[p];
+            _seen[p] += v[p];
+        }
+    }
+    for (const auto& chain : EXTENSION_CHAINS) {
+        const float* a0 = k.angle(chain[0]);
+        const float* a1 = k.angle(chain[1]);
+        const float* v0 = k.valid(chain[0]);
+        const float* v1 = k.valid(chain[1]);
+        for (size_t p = 0; p < n; p++) {
+            float d = std::fabs(a1[p] - a0[p]);
+            d = d > PI_F ? 2.0f * PI_F - d : d;
+            float both = v0[p] * v1[p];
+            _ext[p] += (1.0f - d / PI_F) * both;
+            _ext_n[p] += both;
+        }
+    }
+
+    const float alpha = _config.smoothing;
+    const float wsum = std::max(1e-6f, _config.weight_rhythm + _config.weight_extension + _config.weight_energy);
+    for (size_t p = 0; p < n; p++) {
+        DanceScore& sc = _scores[p];
+        float motion = _seen[p] > 0.0f ? _motion[p] / _seen[p] : 0.0f;
+        float speed = _seen[p] > 0.0f ? _speed[p] / _seen[p] : 0.0f;
+
+        // Accent: the previous frame was a local motion peak above threshold. Score how close it
+        // landed to a beat.
+        if (_motion_prev[p] > _config.accent_threshold && _motion_prev[p] > _motion_prev2[p] && _motion_prev[p] >= motion) {
+            double off = _clock.distance(_t_prev);
+            float aligned = std::max(0.0f, 1.0f - static_cast<float>(off) / _config.beat_tolerance);
+            sc.rhythm = ema(sc.rhythm, aligned, alpha);
+        }
+        if (_ext_n[p] > 0.0f) sc.extension = ema(sc.extension, _ext[p] / _ext_n[p], alpha);
+        if (_seen[p] > 0.0f) sc.energy = ema(sc.energy, std::min(1.0f, speed / _config.energy_target), alpha);
+        sc.total = 100.0f * (_config.weight_rhythm * sc.rhythm + _config.weight_extension * sc.extension +
+                             _config.weight_energy * sc.energy) / wsum;
+
+        _motion_prev2[p] = _motion_prev[p];
+        _motion_prev[p] = motion;
+    }
+    _t_prev = t_sec;
+}
+
+} // namespace simonsays
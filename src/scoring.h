@@ -0,0 +1,69 @@
+// Simon Says: dance scoring on top of KinematicsBatch.
+// Rates each person on rhythm (motion accents landing on the beat), extension (straight arms
+// and legs) and energy (limb speed), each smoothed over time and combined into a 0-100 total.
+
+#pragma once
+
+#include "kinematics.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace simonsays {
+
+struct ScoringConfig {
+    double bpm = 120.0;
+    float beat_tolerance = 0.25f;    // beats an accent may be off and still earn rhythm points
+    float accent_threshold = 2.0f;   // mean |angular velocity| (rad/s) a motion peak needs to count
+    float energy_target = 400.0f;    // mean limb speed (px/s) that earns full energy
+    float smoothing = 0.1f;          // weight of each new sample in the running scores
+    float weight_rhythm = 0.4f;
+    float weight_extension = 0.3f;
+    float weight_energy = 0.3f;
+};
+
+struct DanceScore {
+    float rhythm = 0;     // 0..1
+    float extension = 0;  // 0..1
+    float energy = 0;     // 0..1
+    float total = 0;      // 0..100
+};
+
+class BeatClock {
+public:
+    explicit BeatClock(double bpm, double start_sec = 0.0) : _bpm(bpm), _start(start_sec) {}
+
+    double beats(double t_sec) const { return (t_sec - _start) * _bpm / 60.0; }
+    // Distance to the nearest beat, in beats (0..0.5).
+    double distance(double t_sec) const;
+
+private:
+    double _bpm;
+    double _start;
+};
+
+class ScoringEngine {
+public:
+    explicit ScoringEngine(ScoringConfig config = {}, size_t max_people = 8);
+
+    // Call after every KinematicsBatch::update with the frame time on the beat clock's timeline.
+    void update(const KinematicsBatch& k, double t_sec);
+    void reset();
+
+    size_t people() const { return _people; }
+    const DanceScore& score(size_t person) const { return _scores[person]; }
+    const BeatClock& clock() const { return _clock; }
+
+private:
+    ScoringConfig _config;
+    BeatClock _clock;
+    size_t _people = 0;
+    std::vector<DanceScore> _scores;
+    // Per person. _motion_prev/_motion_prev2 keep the last two frames for accent (peak) detection;
+    // the rest are per-frame sums over limbs.
+    std::vector<float> _motion, _motion_prev, _motion_prev2;
+    std::vector<float> _speed, _seen, _ext, _ext_n;
+    double _t_prev = 0;
+};
+
+} // namespace simonsays
@@ -0,0 +1,53 @@
+// Simon Says: stick man geometry and SDL drawing (see stick_man.h).
+
+#include "stick_man.h"
+#include "trace.h"
+
+namespace simonsays {
+
+void layout_stick_man(const RealSenseID::PersonPose& p, int width, int height, StickFigure& out) {
+    double scaleX = width / CAM_WIDTH;
+    double scaleY = height / CAM_HEIGHT;
+    out.num_lines = 0;
+    out.num_joints = 0;
+
+    for (const auto& conn : POSE_CONNECTIONS) {
+        int i = conn.first, j = conn.second;
+        if (i >= NUM_POSE_LANDMARKS || j >= NUM_POSE_LANDMARKS) continue;
+        uint32_t x0 = p.lm_x[i], y0 = p.lm_y[i], x1 = p.lm_x[j], y1 = p.lm_y[j];
+        if (x0 == 0 && y0 == 0) continue;
+        if (x1 == 0 && y1 == 0) continue;
+        out.lines[out.num_lines++] = {static_cast<int>(x0 * scaleX), static_cast<int>(y0 * scaleY),
+                                      static_cast<int>(x1 * scaleX), static_cast<int>(y1 * scaleY)};
+    }
+
+    for (int i = 0; i < NUM_POSE_LANDMARKS; i++) {
+        if (p.lm_x[i] == 0 && p.lm_y[i] == 0) continue;
+        out.joints[out.num_joints++] = {static_cast<int>(p.lm_x[i] * scaleX), static_cast<int>(p.lm_y[i] * scaleY)};
+    }
+}
+
+#ifndef SIMONSAYS_NO_SDL
+void draw_stick_man(SDL_Renderer* renderer, const std::vector<RealSenseID::PersonPose>& poses, bool stale) {
+    if (poses.empty()) return;
+    SIMONSAYS_TRACE_SCOPE("draw_stick_man", "render");
+    StickFigure fig;
+    layout_stick_man(poses[0], POSE_WINDOW_W, POSE_WINDOW_H, fig);
+
+    if (stale) SDL_SetRenderDrawColor(renderer, 110, 110, 110, 255);
+    else SDL_SetRenderDrawColor(renderer, 0, 200, 100, 255);
+    for (int i = 0; i < fig.num_lines; i++) {
+        const auto& l = fig.lines[i];
+        SDL_RenderDrawLine(renderer, l.x0, l.y0, l.x1, l.y1);
+    }
+
+    if (stale) SDL_SetRenderDrawColor(renderer, 160, 160, 160, 255);
+    else SDL_SetRenderDrawColor(renderer, 255, 220, 0, 255);
+    for (int i = 0; i < fig.num_joints; i++) {
+        SDL_Rect r = { fig.joints[i].x - 4, fig.joints[i].y - 4, 8, 8 };
+        SDL_RenderFillRect(renderer, &r);
+    }
+}
+#endif
+
+} // namespace simonsays
@@ -0,0 +1,38 @@
+// Simon Says: stick man geometry (camera -> window transform) and SDL drawing.
+// Shared by the app window, the GDI fallback and the offscreen load generator.
+
+#pragma once
+
+#include "RealSenseID/FaceAuthenticator.h"
+#include "pose_model.h"
+
+#include <vector>
+
+#ifndef SIMONSAYS_NO_SDL
+#include <SDL.h>
+#endif
+
+namespace simonsays {
+
+constexpr int POSE_WINDOW_W = 640;
+constexpr int POSE_WINDOW_H = 480;
+
+// One pose in window pixels. Keypoints the device reports as (0,0) are left out.
+struct StickFigure {
+    struct Line { int x0, y0, x1, y1; };
+    struct Joint { int x, y; };
+    Line lines[NUM_POSE_CONNECTIONS];
+    Joint joints[NUM_POSE_LANDMARKS];
+    int num_lines = 0;
+    int num_joints = 0;
+};
+
+void layout_stick_man(const RealSenseID::PersonPose& p, int width, int height, StickFigure& out);
+
+#ifndef SIMONSAYS_NO_SDL
+// Draws the first person. stale: the pose stream has stalled, so grey the figure out to tell a
+// frozen pipeline from a frozen player.
+void draw_stick_man(SDL_Renderer* renderer, const std::vector<RealSenseID::PersonPose>& poses, bool stale = false);
+#endif
+
+} // namespace simonsays
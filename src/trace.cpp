@@ -0,0 +1,196 @@
+// Simon Says: Chrome trace-event capture (see trace.h).
+
+#include "trace.h"
+
+#include <algorithm>
+
+namespace simonsays {
+
+namespace {
+
+size_t round_up_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+int64_t since_ns(Clock::time_point t, Clock::time_point origin) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t - origin).count();
+}
+
+} // namespace
+
+std::atomic<bool> Tracer::_enabled{false};
+
+Tracer::Buffer::Buffer(size_t capacity, uint32_t tid_)
+    : events(new Event[capacity]), mask(capacity - 1), tid(tid_) {}
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::~Tracer() {
+    stop();
+}
+
+bool Tracer::start(const std::string& path, TraceConfig config) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::lock_guard<std::mutex> file_lock(_file_mutex);
+    if (_file) return false;
+    _file = std::fopen(path.c_str(), "wb");
+    if (!_file) return false;
+    // Array format: viewers accept it without the closing bracket, so a crash still leaves a
+    // readable trace up to the last flush.
+    std::fputs("[\n", _file);
+    _first_event = true;
+    _written = 0;
+    _config = config;
+    _config.buffer_events = round_up_pow2(std::max<size_t>(config.buffer_events, 2));
+    for (auto& b : _buffers) {  // leftovers from an earlier capture
+        b->tail.store(b->head.load(std::memory_order_acquire), std::memory_order_release);
+        b->dropped = 0;
+    }
+    _origin = Clock::now();
+    _stop = false;
+    _enabled = true;
+    _writer = std::thread([this]() { writer(); });
+    return true;
+}
+
+void Tracer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_file || _stop) return;
+        _enabled = false;
+        _stop = true;
+    }
+    _cv.notify_all();
+    if (_writer.joinable()) _writer.join();
+
+    // Once, at shutdown, so holding the buffer-list lock while writing costs nothing.
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::lock_guard<std::mutex> file_lock(_file_mutex);
+    for (auto& b : _buffers) drain(*b);
+    for (auto& b : _buffers) {
+        if (!b->thread_name) continue;
+        std::fprintf(_file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                     _first_event ? "" : ",\n", b->tid, b->thread_name);
+        _first_event = false;
+    }
+    std::fputs("\n]\n", _file);
+    std::fclose(_file);
+    _file = nullptr;
+}
+
+void Tracer::flush() {
+    const std::vector<Buffer*> rings = buffers();
+    std::lock_guard<std::mutex> file_lock(_file_mutex);
+    if (!_file) return;
+    for (Buffer* b : rings) drain(*b);
+    std::fflush(_file);
+}
+
+void Tracer::complete(const char* name, const char* category, Clock::time_point start, Clock::time_point end,
+                      const char* arg_name, int64_t arg) {
+    if (!enabled()) return;
+    push(Event{name, category, arg_name, arg, since_ns(start, _origin), since_ns(end, _origin) - since_ns(start, _origin),
+               'X'});
+}
+
+void Tracer::instant(const char* name, const char* category) {
+    if (!enabled()) return;
+    push(Event{name, category, nullptr, 0, since_ns(Clock::now(), _origin), 0, 'i'});
+}
+
+void Tracer::name_thread(const char* name) {
+    thread_local bool named = false;
+    if (named) return;
+    Buffer* b = thread_buffer();
+    std::lock_guard<std::mutex> lock(_mutex);
+    b->thread_name = name;
+    named = true;
+}
+
+TraceStats Tracer::stats() const {
+    TraceStats s;
+    for (const Buffer* b : buffers()) s.dropped += b->dropped.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> file_lock(_file_mutex);
+    s.events = _written;
+    return s;
+}
+
+std::vector<Tracer::Buffer*> Tracer::buffers() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<Buffer*> out;
+    out.reserve(_buffers.size());
+    for (const auto& b : _buffers) out.push_back(b.get());
+    return out;
+}
+
+Tracer::Buffer* Tracer::thread_buffer() {
+    thread_local Buffer* buffer = nullptr;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _buffers.push_back(std::unique_ptr<Buffer>(
+            new Buffer(_config.buffer_events, static_cast<uint32_t>(_buffers.size() + 1))));
+        buffer = _buffers.back().get();
+    }
+    return buffer;
+}
+
+void Tracer::push(const Event& e) {
+    Buffer* b = thread_buffer();
+    const uint64_t head = b->head.load(std::memory_order_relaxed);
+    if (head - b->tail.load(std::memory_order_acquire) > b->mask) {
+        b->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    b->events[head & b->mask] = e;
+    b->head.store(head + 1, std::memory_order_release);
+}
+
+void Tracer::writer() {
+    name_thread("trace writer");
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv.wait_for(lock, _config.flush_period, [this]() { return _stop; });
+            if (_stop) return;  // stop() drains what is left
+        }
+        // The rings are never freed, so the snapshot stays valid without the list lock.
+        const std::vector<Buffer*> rings = buffers();
+        std::lock_guard<std::mutex> file_lock(_file_mutex);
+        for (Buffer* b : rings) drain(*b);
+        std::fflush(_file);
+    }
+}
+
+void Tracer::drain(Buffer& b) {
+    uint64_t tail = b.tail.load(std::memory_order_relaxed);
+    const uint64_t head = b.head.load(std::memory_order_acquire);
+    for (; tail != head; ++tail) write_event(b.events[tail & b.mask], b.tid);
+    b.tail.store(tail, std::memory_order_release);
+}
+
+void Tracer::write_event(const Event& e, uint32_t tid) {
+    // Microseconds with three decimals, printed from integers (much cheaper than %f).
+    const long long start_ns = std::max<int64_t>(e.start_ns, 0), dur_ns = std::max<int64_t>(e.dur_ns, 0);
+    char buf[384];
+    int n = std::snprintf(buf, sizeof(buf), "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%lld.%03lld,\"pid\":1,\"tid\":%u",
+                          _first_event ? "" : ",\n", e.name, e.category, e.phase, start_ns / 1000, start_ns % 1000, tid);
+    if (n < 0 || n >= static_cast<int>(sizeof(buf))) return;
+    if (e.phase == 'X')
+        n += std::snprintf(buf + n, sizeof(buf) - n, ",\"dur\":%lld.%03lld", dur_ns / 1000, dur_ns % 1000);
+    else if (e.phase == 'i')
+        n += std::snprintf(buf + n, sizeof(buf) - n, ",\"s\":\"t\"");
+    if (e.arg_name && n < static_cast<int>(sizeof(buf)))
+        n += std::snprintf(buf + n, sizeof(buf) - n, ",\"args\":{\"%s\":%lld}", e.arg_name, static_cast<long long>(e.arg));
+    if (n >= static_cast<int>(sizeof(buf)) - 1) return;
+    buf[n++] = '}';
+    std::fwrite(buf, 1, static_cast<size_t>(n), _file);
+    _first_event = false;
+    ++_written;
+}
+
+} // namespace simonsays
@@ -0,0 +1,173 @@
+// Simon Says: Chrome trace-event capture (load the file in chrome://tracing or ui.perfetto.dev).
+// Each thread records into its own fixed-size ring buffer with no locks (one writer, one reader);
+// a background thread drains the rings into the JSON file every flush_period. A full ring drops
+// the event and counts it rather than blocking the device or render thread.
+//
+// Use the SIMONSAYS_TRACE_* macros. They check a single atomic flag when tracing is not running
+// and compile to nothing when SIMONSAYS_NO_TRACE is defined. Event names must be string literals
+// (only the pointer is stored).
+
+#pragma once
+
+#include "runtime.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace simonsays {
+
+struct TraceConfig {
+    std::chrono::milliseconds flush_period{100};
+    size_t buffer_events = 16384;  // per thread, rounded up to a power of two
+};
+
+struct TraceStats {
+    uint64_t events = 0;   // written to the file
+    uint64_t dropped = 0;  // lost to a full ring
+};
+
+class Tracer {
+public:
+    static Tracer& instance();
+
+    // Starts capturing into path (truncated). Returns false if the file cannot be opened.
+    bool start(const std::string& path, TraceConfig config = {});
+    // Flushes what is buffered, closes the JSON and stops capturing. Safe to call twice.
+    void stop();
+    // Drains every ring into the file now (normally the background writer does this).
+    void flush();
+
+    static bool enabled() { return _enabled.load(std::memory_order_acquire); }
+
+    // Duration event ("X") on the calling thread. arg_name, if set, is shown with arg.
+    void complete(const char* name, const char* category, Clock::time_point start, Clock::time_point end,
+                  const char* arg_name = nullptr, int64_t arg = 0);
+    // Point-in-time event ("i") on the calling thread.
+    void instant(const char* name, const char* category);
+    // Names the calling thread in the viewer. The first name sticks (the fake device runs pose
+    // callbacks on the device worker); later calls cost one thread-local check.
+    void name_thread(const char* name);
+
+    TraceStats stats() const;
+
+private:
+    struct Event {
+        const char* name;
+        const char* category;
+        const char* arg_name;
+        int64_t arg;
+        int64_t start_ns;  // since the trace started
+        int64_t dur_ns;
+        char phase;
+    };
+
+    // Single-producer (owning thread), single-consumer (writer) ring.
+    struct Buffer {
+        explicit Buffer(size_t capacity, uint32_t tid);
+        std::unique_ptr<Event[]> events;
+        const size_t mask;
+        const uint32_t tid;
+        const char* thread_name = nullptr;  // guarded by Tracer::_mutex
+        alignas(64) std::atomic<uint64_t> head{0};  // next slot to write
+        alignas(64) std::atomic<uint64_t> tail{0};  // next slot to read
+        std::atomic<uint64_t> dropped{0};
+    };
+
+    Tracer() = default;
+    ~Tracer();
+
+    Buffer* thread_buffer();
+    void push(const Event& e);
+    void writer();
+    // Copies the buffer list under _mutex, so draining never blocks a thread registering its ring.
+    std::vector<Buffer*> buffers() const;
+    // Caller holds _file_mutex.
+    void drain(Buffer& b);
+    void write_event(const Event& e, uint32_t tid);
+
+    static std::atomic<bool> _enabled;
+
+    // Lock order: _mutex, then _file_mutex. Neither is taken on the recording path.
+    mutable std::mutex _mutex;  // buffer list, thread names, _stop
+    std::vector<std::unique_ptr<Buffer>> _buffers;  // kept after their thread exits
+    mutable std::mutex _file_mutex;  // file contents, ring tails; _file changes under both
+    std::FILE* _file = nullptr;
+    bool _first_event = true;
+    uint64_t _written = 0;
+    TraceConfig _config;
+    Clock::time_point _origin;
+    std::thread _writer;
+    std::condition_variable _cv;
+    bool _stop = false;
+};
+
+// Stops the tracer when it goes out of scope, so early returns still leave a closed JSON file.
+// Does nothing if no capture is running.
+class TraceGuard {
+public:
+    TraceGuard() = default;
+    ~TraceGuard() { Tracer::instance().stop(); }
+    TraceGuard(const TraceGuard&) = delete;
+    TraceGuard& operator=(const TraceGuard&) = delete;
+};
+
+// Records a duration event from construction to destruction.
+class TraceScope {
+public:
+    TraceScope(const char* name, const char* category) : _name(Tracer::enabled() ? name : nullptr), _category(category) {
+        if (_name) _start = Clock::now();
+    }
+    ~TraceScope() {
+        if (_name) Tracer::instance().complete(_name, _category, _start, Clock::now(), _arg_name, _arg);
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    void set_arg(const char* name, int64_t value) {
+        _arg_name = name;
+        _arg = value;
+    }
+
+private:
+    const char* _name;
+    const char* _category;
+    const char* _arg_name = nullptr;
+    int64_t _arg = 0;
+    Clock::time_point _start;
+};
+
+} // namespace simonsays
+
+#define SIMONSAYS_TRACE_CONCAT_(a, b) a##b
+#define SIMONSAYS_TRACE_CONCAT(a, b) SIMONSAYS_TRACE_CONCAT_(a, b)
+
+#ifndef SIMONSAYS_NO_TRACE
+// Traces the rest of the enclosing block.
+#define SIMONSAYS_TRACE_SCOPE(name, category) \
+    ::simonsays::TraceScope SIMONSAYS_TRACE_CONCAT(simonsays_trace_, __LINE__)(name, category)
+// Same, with one numeric argument shown in the viewer (e.g. people in a pose frame).
+#define SIMONSAYS_TRACE_SCOPE_ARG(name, category, arg_name, arg)                                  \
+    ::simonsays::TraceScope SIMONSAYS_TRACE_CONCAT(simonsays_trace_, __LINE__)(name, category); \
+    SIMONSAYS_TRACE_CONCAT(simonsays_trace_, __LINE__).set_arg(arg_name, static_cast<int64_t>(arg))
+#define SIMONSAYS_TRACE_INSTANT(name, category) \
+    do { \
+        if (::simonsays::Tracer::enabled()) ::simonsays::Tracer::instance().instant(name, category); \
+    } while (0)
+#define SIMONSAYS_TRACE_THREAD_NAME(name) \
+    do { \
+        if (::simonsays::Tracer::enabled()) ::simonsays::Tracer::instance().name_thread(name); \
+    } while (0)
+#else
+#define SIMONSAYS_TRACE_SCOPE(name, category) do {} while (0)
+#define SIMONSAYS_TRACE_SCOPE_ARG(name, category, arg_name, arg) do {} while (0)
+#define SIMONSAYS_TRACE_INSTANT(name, category) do {} while (0)
+#define SIMONSAYS_TRACE_THREAD_NAME(name) do {} while (0)
+#endif
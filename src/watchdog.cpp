@@ -0,0 +1,107 @@
+// Simon Says: stale-frame watchdog (see watchdog.h).
+
+#include "watchdog.h"
+
+#include <algorithm>
+
+namespace simonsays {
+
+namespace {
+
+double to_ms(Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+} // namespace
+
+PoseWatchdog::PoseWatchdog(WatchdogConfig config) : _config(config), _last_arrival(Clock::now()) {}
+
+double PoseWatchdog::link_delay_ms(unsigned int device_ts, Clock::time_point arrival) const {
+    if (!_have_offset) return 0;
+    double offset = to_ms(arrival.time_since_epoch()) - device_ts;
+    return std::max(0.0, offset - _min_offset_ms);
+}
+
+void PoseWatchdog::on_arrival(unsigned int device_ts, Clock::time_point arrival) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_stats.frames;
+    _last_arrival = arrival;
+    _stalled = false;
+    _stall_reported = false;
+
+    // Device clock went backwards (loop restarted or wrapped): start a new baseline.
+    double offset = to_ms(arrival.time_since_epoch()) - device_ts;
+    if (!_have_offset || device_ts < _last_device_ts) {
+        _min_offset_ms = offset;
+        _have_offset = true;
+    } else {
+        // Let the baseline creep up slowly so host/device clock drift is not mistaken for delay.
+        _min_offset_ms = std::min(_min_offset_ms + 0.01, offset);
+    }
+    _last_device_ts = device_ts;
+
+    while (!_recent.empty() && arrival - _recent.front() > _config.burst_window) _recent.pop_front();
+    _recent.push_back(arrival);
+    bool burst = _recent.size() >= _config.burst_frames;
+    if (burst && !_in_burst) ++_stats.bursts;
+    _in_burst = burst;
+}
+
+bool PoseWatchdog::admit(unsigned int device_ts, Clock::time_point arrival, Clock::time_point now, size_t queue_depth) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    bool backpressure = queue_depth >= _config.backpressure_depth;
+    if (backpressure && !_in_backpressure) ++_stats.backpressure;
+    _in_backpressure = backpressure;
+
+    if (arrival < _restarted_at) {
+        ++_stats.stale_dropped;
+        return false;
+    }
+    double delay = link_delay_ms(device_ts, arrival);
+    double age = delay + to_ms(now - arrival);
+    if (age > static_cast<double>(_config.frame_deadline.count())) {
+        ++_stats.stale_dropped;
+        return false;
+    }
+    _stats.max_pose_age_ms = std::max(_stats.max_pose_age_ms, age);
+    _last_processed = arrival;
+    _last_processed_delay_ms = delay;
+    _have_processed = true;
+    return true;
+}
+
+bool PoseWatchdog::check(Clock::time_point now, bool streaming) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!streaming) {
+        // Re-auth or restart in progress; nothing is expected until the loop is back.
+        _last_arrival = now;
+        _stall_reported = false;
+        return false;
+    }
+    if (_stall_reported || now - _last_arrival < _config.stall_timeout) return false;
+    _stalled = true;  // stays set (renderer shows it) until a frame arrives
+    _stall_reported = true;
+    ++_stats.stalls;
+    return true;
+}
+
+void PoseWatchdog::note_restart(Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_stats.restarts;
+    _restarted_at = now;
+    _have_offset = false;
+}
+
+bool PoseWatchdog::stalled() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stalled;
+}
+
+WatchdogStats PoseWatchdog::stats(Clock::time_point now) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    WatchdogStats s = _stats;
+    s.pose_age_ms = _have_processed ? _last_processed_delay_ms + to_ms(now - _last_processed) : 0;
+    return s;
+}
+
+} // namespace simonsays
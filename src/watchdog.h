@@ -0,0 +1,78 @@
+// Simon Says: stale-frame watchdog for the pose stream.
+// Uses the OnPoseDetected device timestamp and host arrival time to spot stalls (no callbacks),
+// bursts (callbacks bunched up after a serial hiccup), back-pressure (processing falling behind)
+// and to drop frames that are already past their deadline before they are processed.
+
+#pragma once
+
+#include "runtime.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+namespace simonsays {
+
+struct WatchdogConfig {
+    std::chrono::milliseconds frame_deadline{200};  // older frames are dropped before processing
+    std::chrono::milliseconds stall_timeout{3000};  // no callbacks while streaming -> stall
+    std::chrono::milliseconds burst_window{100};
+    size_t burst_frames = 5;        // this many arrivals inside burst_window -> burst
+    size_t backpressure_depth = 4;  // processing queue depth that counts as back-pressure
+};
+
+struct WatchdogStats {
+    uint64_t frames = 0;
+    uint64_t stale_dropped = 0;
+    uint64_t stalls = 0;
+    uint64_t bursts = 0;
+    uint64_t backpressure = 0;
+    uint64_t restarts = 0;
+    double pose_age_ms = 0;      // age of the newest processed pose right now
+    double max_pose_age_ms = 0;  // worst age seen at processing time
+};
+
+class PoseWatchdog {
+public:
+    explicit PoseWatchdog(WatchdogConfig config = {});
+
+    // Device callback thread, for every frame (authenticated or not).
+    void on_arrival(unsigned int device_ts, Clock::time_point arrival);
+    // Processing thread. Returns false if the frame is past its deadline and should be dropped.
+    bool admit(unsigned int device_ts, Clock::time_point arrival, Clock::time_point now, size_t queue_depth);
+    // Executor. Returns true when the stream has just been declared stalled.
+    bool check(Clock::time_point now, bool streaming);
+    // Executor, when the pose loop is restarted. Frames that arrived before now are from the old
+    // loop: admit() drops them, and the next arrival starts a new device-clock baseline.
+    void note_restart(Clock::time_point now);
+
+    bool stalled() const;
+    const WatchdogConfig& config() const { return _config; }
+    WatchdogStats stats(Clock::time_point now) const;
+
+private:
+    // Host-side link delay of a frame: how much later than the fastest frame seen it arrived,
+    // relative to the device clock.
+    double link_delay_ms(unsigned int device_ts, Clock::time_point arrival) const;
+
+    const WatchdogConfig _config;
+    mutable std::mutex _mutex;
+    WatchdogStats _stats;
+    std::deque<Clock::time_point> _recent;  // arrivals inside burst_window
+    Clock::time_point _last_arrival;
+    Clock::time_point _last_processed;
+    Clock::time_point _restarted_at;
+    double _last_processed_delay_ms = 0;
+    bool _have_processed = false;
+    unsigned int _last_device_ts = 0;
+    double _min_offset_ms = 0;
+    bool _have_offset = false;
+    bool _in_burst = false;
+    bool _in_backpressure = false;
+    bool _stalled = false;
+    bool _stall_reported = false;  // once per streaming period
+};
+
+} // namespace simonsays
@@ -0,0 +1,173 @@
+// Simon Says kinematics test: limb angles and rates, beat distance and the extension and rhythm
+// scores against hand-computed values. Exits non-zero if any check fails.
+//
+// Usage: simonsays_kinematics_test
+
+#include "kinematics.h"
+#include "scoring.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;  // M_PI is not standard
+
+int g_failures = 0;
+
+void check_near(const char* what, double actual, double expected, double tolerance) {
+    if (std::fabs(actual - expected) <= tolerance) return;
+    std::printf("FAIL %s: got %.6f, expected %.6f (+/- %g)\n", what, actual, expected, tolerance);
+    ++g_failures;
+}
+
+// Limb 0 runs from keypoint 15 (ankle) to keypoint 13 (knee), limb 1 from 13 to 11 (hip).
+constexpr int ANKLE = 15, KNEE = 13, HIP = 11;
+
+struct Point {
+    uint32_t x, y;
+};
+
+// A pose with only the given keypoints seen (unseen keypoints are (0, 0)).
+RealSenseID::PersonPose pose(std::initializer_list<std::pair<int, Point>> keypoints) {
+    RealSenseID::PersonPose p = {};
+    for (const auto& k : keypoints) {
+        p.lm_x[k.first] = k.second.x;
+        p.lm_y[k.first] = k.second.y;
+    }
+    return p;
+}
+
+// The knee on a circle of radius 1000 around the ankle, at angle a (y down, as in the camera).
+RealSenseID::PersonPose shin_at(double a) {
+    const Point ankle = {5000, 5000};
+    const Point knee = {static_cast<uint32_t>(std::lround(5000 + 1000 * std::cos(a))),
+                        static_cast<uint32_t>(std::lround(5000 + 1000 * std::sin(a)))};
+    return pose({{ANKLE, ankle}, {KNEE, knee}});
+}
+
+void test_angles() {
+    simonsays::KinematicsBatch k(1);
+    k.update({pose({{ANKLE, {100, 100}}, {KNEE, {100, 200}}})}, 0.0f);
+    check_near("angle, straight down", k.angle(0)[0], PI / 2, 1e-3);
+    check_near("valid, both keypoints seen", k.valid(0)[0], 1.0, 0.0);
+    check_near("valid, hip unseen", k.valid(1)[0], 0.0, 0.0);
+
+    k.update({pose({{ANKLE, {100, 100}}, {KNEE, {200, 200}}})}, 0.0f);
+    check_near("angle, 45 degrees", k.angle(0)[0], PI / 4, 1e-3);
+    k.update({pose({{ANKLE, {200, 100}}, {KNEE, {100, 100}}})}, 0.0f);
+    check_near("angle, pointing left", std::fabs(k.angle(0)[0]), PI, 1e-3);
+}
+
+void test_rates() {
+    simonsays::KinematicsBatch k(1);
+    k.update({shin_at(0.0)}, 0.0f);
+    check_near("angular velocity, first frame", k.angular_velocity(0)[0], 0.0, 0.0);
+
+    // +pi/4 in 0.1 s, then +pi/4 in 0.05 s.
+    k.update({shin_at(PI / 4)}, 0.1f);
+    const double w1 = (PI / 4) / 0.1;
+    check_near("angular velocity", k.angular_velocity(0)[0], w1, 0.01 * w1);
+    check_near("angular acceleration, no previous velocity", k.angular_acceleration(0)[0], 0.0, 0.0);
+
+    k.update({shin_at(PI / 2)}, 0.05f);
+    const double w2 = (PI / 4) / 0.05;
+    check_near("angular velocity, shorter dt", k.angular_velocity(0)[0], w2, 0.01 * w2);
+    check_near("angular acceleration", k.angular_acceleration(0)[0], (w2 - w1) / 0.05, 0.02 * (w2 - w1) / 0.05);
+
+    // Crossing +-pi is a small turn, not almost a full one.
+    simonsays::KinematicsBatch wrap(1);
+    wrap.update({shin_at(PI - 0.1)}, 0.0f);
+    wrap.update({shin_at(-PI + 0.1)}, 0.1f);
+    check_near("angular velocity across +-pi", wrap.angular_velocity(0)[0], 0.2 / 0.1, 0.01 * 2.0);
+}
+
+void test_midpoint_speed() {
+    simonsays::KinematicsBatch k(1);
+    k.update({pose({{ANKLE, {100, 100}}, {KNEE, {200, 100}}})}, 0.0f);
+    check_near("limb speed, first frame", k.limb_speed(0)[0], 0.0, 0.0);
+    // Whole limb moves by (30, 40): 50 px in 0.1 s.
+    k.update({pose({{ANKLE, {130, 140}}, {KNEE, {230, 140}}})}, 0.1f);
+    check_near("limb speed", k.limb_speed(0)[0], 500.0, 0.5);
+    check_near("angular velocity, pure translation", k.angular_velocity(0)[0], 0.0, 0.01);
+}
+
+void test_beat_distance() {
+    simonsays::BeatClock clock(120.0);  // a beat every 0.5 s
+    check_near("on the beat", clock.distance(1.0), 0.0, 1e-9);
+    check_near("half a beat off", clock.distance(1.25), 0.5, 1e-9);
+    check_near("just after a beat", clock.distance(1.1), 0.2, 1e-9);
+    check_near("just before a beat (wraps to the next one)", clock.distance(0.95), 0.1, 1e-9);
+    check_near("before the start", clock.distance(-0.1), 0.2, 1e-9);
+
+    simonsays::BeatClock offset(60.0, 0.25);
+    check_near("offset start, on the beat", offset.distance(1.25), 0.0, 1e-9);
+    check_near("offset start, late", offset.distance(1.5), 0.25, 1e-9);
+}
+
+void test_extension_score() {
+    // Defaults: smoothing 0.1, weights 0.4 / 0.3 / 0.3. One frame, no dt: no rhythm or energy.
+    simonsays::KinematicsBatch k(1);
+    simonsays::ScoringEngine straight;
+    k.update({pose({{ANKLE, {100, 300}}, {KNEE, {100, 200}}, {HIP, {100, 100}}})}, 0.0f);
+    straight.update(k, 0.0);
+    check_near("extension, straight leg", straight.score(0).extension, 0.1, 1e-4);  // 0 + 0.1 * (1 - 0)
+    check_near("energy, first frame", straight.score(0).energy, 0.0, 0.0);
+    check_near("total, straight leg", straight.score(0).total, 100.0 * 0.3 * 0.1, 1e-2);
+    straight.update(k, 0.1);
+    check_near("extension, smoothed", straight.score(0).extension, 0.19, 1e-4);  // 0.1 + 0.1 * (1 - 0.1)
+
+    // Knee bent at a right angle: 1 - (pi/2) / pi = 0.5.
+    simonsays::KinematicsBatch bent_k(1);
+    simonsays::ScoringEngine bent;
+    bent_k.update({pose({{ANKLE, {100, 300}}, {KNEE, {100, 200}}, {HIP, {200, 200}}})}, 0.0f);
+    bent.update(bent_k, 0.0);
+    check_near("extension, right-angle knee", bent.score(0).extension, 0.05, 1e-4);
+
+    bent.reset();
+    check_near("extension after reset", bent.score(0).extension, 0.0, 0.0);
+    check_near("people after reset", static_cast<double>(bent.people()), 0.0, 0.0);
+}
+
+// A motion peak (|w| 1 -> 5 -> 1 rad/s) at peak_t; the accent is scored one frame later.
+float rhythm_for_peak_at(double peak_t) {
+    const double dt = 0.1;
+    const double turns[] = {0.0, 0.1, 0.5, 0.1};  // rad per frame
+    simonsays::KinematicsBatch k(1);
+    simonsays::ScoringEngine scoring;  // 120 bpm, tolerance 0.25 beats, threshold 2 rad/s
+    double a = 0.0;
+    for (int f = 0; f < 4; f++) {
+        a += turns[f];
+        k.update({shin_at(a)}, f == 0 ? 0.0f : static_cast<float>(dt));
+        scoring.update(k, peak_t + (f - 2) * dt);
+    }
+    return scoring.score(0).rhythm;
+}
+
+void test_rhythm_score() {
+    check_near("rhythm, accent on the beat", rhythm_for_peak_at(1.0), 0.1, 1e-4);  // 0.1 * 1
+    // 1.1 s = 2.2 beats: 0.2 beats off -> 1 - 0.2 / 0.25 = 0.2.
+    check_near("rhythm, accent 0.2 beats late", rhythm_for_peak_at(1.1), 0.02, 1e-4);
+    check_near("rhythm, accent off the beat", rhythm_for_peak_at(1.25), 0.0, 1e-6);
+}
+
+} // namespace
+
+int main() {
+    test_angles();
+    test_rates();
+    test_midpoint_speed();
+    test_beat_distance();
+    test_extension_score();
+    test_rhythm_score();
+    if (g_failures) {
+        std::printf("%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("All kinematics checks passed\n");
+    return 0;
+}